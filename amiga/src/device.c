@@ -137,7 +137,6 @@ PRIVATE VOID abort(BASEPTR, struct IOSana2Req *ior);
    NewList((struct List*)&pb->pb_WriteList);
    NewList((struct List*)&pb->pb_EventList);
    NewList((struct List*)&pb->pb_ReadOrphanList);
-   NewList((struct List*)&pb->pb_TrackList);
    NewList((struct List*)&pb->pb_BufferManagement);
 
       /* initialise the access protection semaphores */
@@ -521,6 +520,7 @@ PRIVATE VOID abort(BASEPTR, struct IOSana2Req *ior);
               /* set broadcast addr: ff:ff:ff:ff:ff:ff */
          memset(ios2->ios2_DstAddr, 0xff, HW_ADDRFIELDSIZE);
               /* fall through */
+      case S2_MULTICAST:
       case CMD_WRITE:
               /* determine max valid size */
          mtu = pb->pb_MTU;
@@ -531,6 +531,11 @@ PRIVATE VOID abort(BASEPTR, struct IOSana2Req *ior);
          {
             ios2->ios2_Req.io_Error = S2ERR_MTU_EXCEEDED;
          }
+         else if ((ios2->ios2_Req.io_Command == S2_MULTICAST) && !(ios2->ios2_DstAddr[0] & 1))
+         {
+            ios2->ios2_Req.io_Error = S2ERR_BAD_ADDRESS;
+            ios2->ios2_WireError = S2WERR_BAD_MULTICAST;
+         }
          else if (ios2->ios2_BufferManagement == NULL)
          {
             ios2->ios2_Req.io_Error = S2ERR_BAD_ARGUMENT;
@@ -560,6 +565,21 @@ PRIVATE VOID abort(BASEPTR, struct IOSana2Req *ior);
          ios2 = NULL;
       break;
 
+      case S2_ADDMULTICASTADDRESS:
+      case S2_DELMULTICASTADDRESS:
+         if (!(ios2->ios2_SrcAddr[0] & 1))
+         {
+            ios2->ios2_Req.io_Error = S2ERR_BAD_ADDRESS;
+            ios2->ios2_WireError = S2WERR_BAD_MULTICAST;
+         }
+         else
+         {
+            /* server owns the table and updates the plipbox filter */
+            DevForwardIO(pb, ios2);
+            ios2 = NULL;
+         }
+      break;
+
       case S2_GETSTATIONADDRESS:
          memcpy(ios2->ios2_SrcAddr, pb->pb_CfgAddr, HW_ADDRFIELDSIZE); /* current */
          memcpy(ios2->ios2_DstAddr, pb->pb_DefAddr, HW_ADDRFIELDSIZE); /* default */
@@ -695,9 +715,6 @@ PRIVATE VOID abort(BASEPTR, struct IOSana2Req *ior);
       break;
 
          /* other commands (SANA-2) we don't support */
-      /*case S2_ADDMULTICASTADDRESS:*/
-      /*case S2_DELMULTICASTADDRESS:*/
-      /*case S2_MULTICAST:*/
       default:
          ios2->ios2_Req.io_Error = S2ERR_NOT_SUPPORTED;
          ios2->ios2_WireError = S2WERR_GENERIC_ERROR;
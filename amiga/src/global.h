@@ -38,13 +38,36 @@
    /* memory economy is *everything* :-) */
 #define SERVERTASKNAME           pb->pb_DevNode.lib_Node.ln_Name
 
+   /* number of packet types that can be tracked (power of 2) */
+#define PLIP_TRACKSLOTS          16
+
+   /*
+   ** slots of the track table are hashed by packet type. a slot is
+   ** tracked as long as tr_Count != 0. tr_Used stays set after the
+   ** first use to keep the probe chain intact.
+   */
 struct TrackRec {
-   struct MinNode              tr_Link;
    ULONG                       tr_PacketType;
-   ULONG                       tr_Count;
+   volatile UWORD              tr_Count;
+   UWORD                       tr_Used;
    struct Sana2PacketTypeStats tr_Sana2PacketTypeStats;
 };
 
+   /* number of multicast addresses the plipbox filter accepts */
+#define PLIP_MCASTSLOTS          32
+
+   /*
+   ** multicast addresses added by S2_ADDMULTICASTADDRESS. a slot is
+   ** free if mcr_Count == 0. only the server task touches this table.
+   */
+struct MCastRec {
+   UBYTE                       mcr_Addr[HW_ADDRFIELDSIZE];
+   UWORD                       mcr_Count;
+};
+
+   /* return codes of addmcast()/remmcast() */
+typedef enum { MC_ERROR, MC_KEPT, MC_CHANGED } MC_RESULT;
+
 
 /****************************************************************************/
 
@@ -117,7 +140,6 @@ struct PLIPBase
                                pb_WriteList,                 /* the writers */
                                pb_EventList,              /* event tracking */
                                pb_ReadOrphanList,   /* for spurious packets */
-                               pb_TrackList,                  /* track type */
                                pb_BufferManagement;          /* Copy-In/Out */
    struct SignalSemaphore      pb_EventListSem,     /* protection for lists */
                                pb_ReadListSem,
@@ -135,6 +157,8 @@ struct PLIPBase
    struct HWFrame        *     pb_Frame;
    ULONG                       pb_BPS;
    ULONG                       pb_MTU;
+   struct TrackRec             pb_TrackRecs[PLIP_TRACKSLOTS]; /* track type */
+   struct MCastRec             pb_MCastRecs[PLIP_MCASTSLOTS];  /* multicast */
 };
 
 #ifdef __SASC
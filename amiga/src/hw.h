@@ -8,6 +8,7 @@
 #define HW_MAGIC_ONLINE    0xffff
 #define HW_MAGIC_OFFLINE   0xfffe
 #define HW_MAGIC_LOOPBACK  0xfffd
+#define HW_MAGIC_MCAST     0xfffc    /* data: UWORD count, count * address */
 
    /* transport ethernet addresses */
 #define HW_ADDRFIELDSIZE         6
@@ -53,6 +54,11 @@ GLOBAL REGARGS ULONG hw_recv_sigmask(struct PLIPBase *pb);
 GLOBAL REGARGS BOOL hw_recv_pending(struct PLIPBase *pb);
 GLOBAL REGARGS BOOL hw_recv_frame(struct PLIPBase *pb, struct HWFrame *frame);
 
+/* peek: fetch size and ethernet header only, then recv or skip the frame */
+GLOBAL REGARGS BOOL hw_recv_can_peek(struct PLIPBase *pb);
+GLOBAL REGARGS BOOL hw_recv_peek(struct PLIPBase *pb, struct HWFrame *frame);
+GLOBAL REGARGS BOOL hw_recv_skip(struct PLIPBase *pb);
+
 GLOBAL REGARGS void hw_config_init(struct PLIPBase *pb);
 GLOBAL REGARGS void hw_config_update(struct PLIPBase *pb, struct TemplateConfig *cfg);
 GLOBAL REGARGS void hw_config_dump(struct PLIPBase *pb);
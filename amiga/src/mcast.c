@@ -0,0 +1,115 @@
+/*F*/ /* includes */
+#ifndef CLIB_EXEC_PROTOS_H
+#include <clib/exec_protos.h>
+#include <pragmas/exec_sysbase_pragmas.h>
+#endif
+
+#ifndef _STRING_H
+#include <string.h>
+#endif
+
+#ifndef __GLOBAL_H
+#include "global.h"
+#endif
+
+#ifndef __DEBUG_H
+#include "debug.h"
+#endif
+
+#ifndef __HW_H
+#include "hw.h"
+#endif
+
+/*E*/
+/*F*/ /* exports */
+PUBLIC MC_RESULT addmcast(BASEPTR, UBYTE *addr);
+PUBLIC MC_RESULT remmcast(BASEPTR, UBYTE *addr);
+PUBLIC BOOL sendmcasts(BASEPTR);
+/*E*/
+/*F*/ /* private */
+PRIVATE struct MCastRec *findmcast(BASEPTR, UBYTE *addr);
+/*E*/
+
+   /*
+   ** the multicast table is reference counted: the plipbox filter only
+   ** has to be updated if an address is added first or removed last.
+   */
+/*F*/ PRIVATE struct MCastRec *findmcast(BASEPTR, UBYTE *addr)
+{
+   struct MCastRec *mcr = pb->pb_MCastRecs;
+   UWORD i;
+
+   for (i = 0; i < PLIP_MCASTSLOTS; i++, mcr++)
+   {
+      if (mcr->mcr_Count && !memcmp(mcr->mcr_Addr, addr, HW_ADDRFIELDSIZE))
+         return( mcr );
+   }
+
+   return( NULL );
+}
+/*E*/
+/*F*/ PUBLIC MC_RESULT addmcast(BASEPTR, UBYTE *addr)
+{
+   struct MCastRec *mcr;
+   UWORD i;
+
+   if (mcr = findmcast(pb, addr))
+   {
+      ++mcr->mcr_Count;
+      return MC_KEPT;
+   }
+
+   for (i = 0, mcr = pb->pb_MCastRecs; i < PLIP_MCASTSLOTS; i++, mcr++)
+   {
+      if (!mcr->mcr_Count)
+      {
+         memcpy(mcr->mcr_Addr, addr, HW_ADDRFIELDSIZE);
+         mcr->mcr_Count = 1;
+         return MC_CHANGED;
+      }
+   }
+
+   d(("multicast table full\n"));
+   return MC_ERROR;
+}
+/*E*/
+/*F*/ PUBLIC MC_RESULT remmcast(BASEPTR, UBYTE *addr)
+{
+   struct MCastRec *mcr;
+
+   if (!(mcr = findmcast(pb, addr)))
+      return MC_ERROR;
+
+   return (--mcr->mcr_Count) ? MC_KEPT : MC_CHANGED;
+}
+/*E*/
+/*F*/ PUBLIC BOOL sendmcasts(BASEPTR)
+{
+   struct HWFrame *frame = pb->pb_Frame;
+   struct MCastRec *mcr = pb->pb_MCastRecs;
+   UBYTE *data = (UBYTE *)(frame + 1);
+   UBYTE *addr = data + sizeof(UWORD);
+   UWORD num = 0;
+   UWORD i;
+
+   /* magic frame: UWORD count followed by the addresses to accept */
+   for (i = 0; i < PLIP_MCASTSLOTS; i++, mcr++)
+   {
+      if (mcr->mcr_Count)
+      {
+         memcpy(addr, mcr->mcr_Addr, HW_ADDRFIELDSIZE);
+         addr += HW_ADDRFIELDSIZE;
+         num++;
+      }
+   }
+   *(UWORD *)data = num;
+
+   frame->hwf_Size = HW_ETH_HDR_SIZE + sizeof(UWORD) + num * HW_ADDRFIELDSIZE;
+   memcpy(frame->hwf_SrcAddr, pb->pb_CfgAddr, HW_ADDRFIELDSIZE);
+   memset(frame->hwf_DstAddr, 0, HW_ADDRFIELDSIZE);
+   frame->hwf_Type = HW_MAGIC_MCAST;
+
+   d(("send %ld multicast addresses\n", (ULONG)num));
+   return hw_send_frame(pb, frame);
+}
+/*E*/
@@ -80,6 +80,8 @@ GLOBAL BOOL ASM hwsend(REG(a0) struct HWBase *hwb, REG(a1) struct HWFrame *frame
 GLOBAL BOOL ASM hwrecv(REG(a0) struct HWBase *hwb, REG(a1) struct HWFrame *frame);
 GLOBAL BOOL ASM hwburstsend(REG(a0) struct HWBase *, REG(a1) struct HWFrame *);
 GLOBAL BOOL ASM hwburstrecv(REG(a0) struct HWBase *, REG(a1) struct HWFrame *);
+GLOBAL BOOL ASM hwpeek(REG(a0) struct HWBase *, REG(a1) struct HWFrame *);
+GLOBAL BOOL ASM hwskip(REG(a0) struct HWBase *);
 
    /* amiga.lib provides for these symbols */
 GLOBAL FAR volatile struct CIA ciaa,ciab;
@@ -135,6 +137,7 @@ GLOBAL REGARGS void hw_config_init(struct PLIPBase *pb)
   hwb->hwb_TimeOutSecs = PLIP_DEFTIMEOUT / 1000000L;
   hwb->hwb_TimeOutMicros = PLIP_DEFTIMEOUT % 1000000L;
   hwb->hwb_BurstMode = 1;
+  hwb->hwb_PeekMode = 0;
 }
 
 GLOBAL REGARGS void hw_config_update(struct PLIPBase *pb, struct TemplateConfig *args)
@@ -150,6 +153,10 @@ GLOBAL REGARGS void hw_config_update(struct PLIPBase *pb, struct TemplateConfig
   if(args->no_burst) {
     hwb->hwb_BurstMode = 0;
   }
+
+  if(args->peek) {
+    hwb->hwb_PeekMode = 1;
+  }
 }
 
 GLOBAL REGARGS void hw_config_dump(struct PLIPBase *pb)
@@ -159,6 +166,7 @@ GLOBAL REGARGS void hw_config_dump(struct PLIPBase *pb)
 #endif
   d(("timeOut %ld.%ld\n", hwb->hwb_TimeOutSecs, hwb->hwb_TimeOutMicros));
   d(("burstSize %ld\n", (ULONG)hwb->hwb_BurstSize));
+  d(("peekMode %ld\n", (ULONG)hwb->hwb_PeekMode));
 }
 
 GLOBAL REGARGS BOOL hw_init(struct PLIPBase *pb)
@@ -443,6 +451,62 @@ GLOBAL REGARGS BOOL hw_recv_frame(struct PLIPBase *pb, struct HWFrame *frame)
    return rc;
 }
 
+GLOBAL REGARGS BOOL hw_recv_can_peek(struct PLIPBase *pb)
+{
+   struct HWBase *hwb = &pb->pb_HWBase;
+   return hwb->hwb_PeekMode ? TRUE : FALSE;
+}
+
+GLOBAL REGARGS BOOL hw_recv_peek(struct PLIPBase *pb, struct HWFrame *frame)
+{
+   struct HWBase *hwb = &pb->pb_HWBase;
+   BOOL rc;
+
+   /* wait until I/O block is safe to be reused */
+   while(!hwb->hwb_TimeoutSet) Delay(1L);
+
+   /* start new timeout timer */
+   hwb->hwb_TimeoutReq.tr_time.tv_secs    = hwb->hwb_TimeOutSecs;
+   hwb->hwb_TimeoutReq.tr_time.tv_micro   = hwb->hwb_TimeOutMicros;
+   hwb->hwb_TimeoutSet = 0;
+   SendIO((struct IORequest*)&hwb->hwb_TimeoutReq);
+
+   /* hw peek: only size and ethernet header */
+   d8(("+peek\n"));
+   rc = hwpeek(hwb, frame);
+   d8(("-peek: %s\n", rc ? "ok":"ERR"));
+
+   /* stop timeout timer */
+   AbortIO((struct IORequest*)&hwb->hwb_TimeoutReq);
+
+   return rc;
+}
+
+GLOBAL REGARGS BOOL hw_recv_skip(struct PLIPBase *pb)
+{
+   struct HWBase *hwb = &pb->pb_HWBase;
+   BOOL rc;
+
+   /* wait until I/O block is safe to be reused */
+   while(!hwb->hwb_TimeoutSet) Delay(1L);
+
+   /* start new timeout timer */
+   hwb->hwb_TimeoutReq.tr_time.tv_secs    = hwb->hwb_TimeOutSecs;
+   hwb->hwb_TimeoutReq.tr_time.tv_micro   = hwb->hwb_TimeOutMicros;
+   hwb->hwb_TimeoutSet = 0;
+   SendIO((struct IORequest*)&hwb->hwb_TimeoutReq);
+
+   /* hw skip: plipbox drops the peeked frame */
+   d8(("+skip\n"));
+   rc = hwskip(hwb);
+   d8(("-skip: %s\n", rc ? "ok":"ERR"));
+
+   /* stop timeout timer */
+   AbortIO((struct IORequest*)&hwb->hwb_TimeoutReq);
+
+   return rc;
+}
+
 GLOBAL REGARGS ULONG hw_recv_sigmask(struct PLIPBase *pb)
 {
    struct HWBase *hwb = &pb->pb_HWBase;
@@ -35,6 +35,7 @@ struct HWBase
    ULONG                       hwb_TimeOutMicros;
    ULONG                       hwb_TimeOutSecs;
    UWORD                       hwb_BurstMode;
+   UWORD                       hwb_PeekMode;
 };
 
 #define HWB_RECV_PENDING           0
@@ -51,7 +52,7 @@ struct HWBase
 /* ----- config ----- */
 
 #define CONFIGFILE "ENV:SANA2/plipbox.config"
-#define TEMPLATE "TIMEOUT/K/N,NOBURST/S"
+#define TEMPLATE "TIMEOUT/K/N,NOBURST/S,PEEK/S"
 
 /* structure to be filled by ReadArgs template */ 
 struct TemplateConfig
@@ -59,6 +60,7 @@ struct TemplateConfig
    struct CommonConfig common;
    ULONG *timeout;
    ULONG no_burst;
+   ULONG peek;
 };
 
 #endif
@@ -18,6 +18,8 @@
       xdef    _hwrecv
       xdef    _hwburstsend
       xdef    _hwburstrecv
+      xdef    _hwpeek
+      xdef    _hwskip
 
 
 ciaa     equ     $bfe001
@@ -705,4 +707,253 @@ bwr_ExitError:
          movem.l  (sp)+,d2-d7/a2-a6
          rts
 
+;----------------------------------------------------------------------------
+;
+; NAME
+;     hwpeek() - low level receive of the next packet's header
+;
+; SYNOPSIS
+;     void hwpeek(struct HWBase *, struct HWFrame *)
+;                 A0               A1
+;
+; FUNCTION
+;     Receive the full size and only the first HWF_PEEKSIZE bytes (the
+;     ethernet header) of the next packet. The plipbox keeps the packet
+;     until it is fetched with hwrecv()/hwburstrecv() or dropped with
+;     hwskip().
+;
+_hwpeek:
+         movem.l  d2-d7/a2-a6,-(sp)
+         move.l   a0,a2                               ; a2 = HWBase
+         move.l   a1,a3                               ; a3 = HWFrame
+         moveq    #FALSE,d5                           ; d5 = return value
+         move.l   hwb_SysBase(a2),a6                  ; a6 = SysBase
+         moveq    #HS_REQ_BIT,d3                      ; d3 = HS_REQ
+         moveq    #HS_RAK_BIT,d4                      ; d4 = HS_RAK
+         lea      BaseAX,a5                           ; a5 = ciab+ciapra
+
+         ; --- prepare
+         ; Wait RAK == 0
+hwp_WaitRak1:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0
+         beq.s    hwp_RakOk1
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hwp_WaitRak1
+         bra      hwp_ExitError
+hwp_RakOk1:
+
+         ; --- init handshake
+         ; [OUT]
+         SETCIAOUTPUT a5
+
+         ; Set <CMD_RECV_PEEK>
+         move.b   #HWF_CMD_RECV_PEEK,ciaa+ciaprb-BaseAX(a5)
+
+         ; Set SEL = 1 -> trigger Plipbox
+         SETSELECT a5
+
+         ; Wait RAK == 1
+hwp_WaitRak2:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0
+         bne.s    hwp_RakOk2
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hwp_WaitRak2
+         bra.s    hwp_ExitError
+hwp_RakOk2:
+
+         ; [IN]
+         SETCIAINPUT a5
+
+         ; Set REQ = 1
+         bset     d3,(a5)
+
+         ; --- read size word ---
+         ; Wait RAK == 0
+hwp_WaitRak3:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0                               ; RAK toggled?
+         beq.s    hwp_RakOk3
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hwp_WaitRak3
+         bra.s    hwp_ExitError
+hwp_RakOk3:
+
+         ; Read <Size_Hi>
+         move.b   ciaa+ciaprb-BaseAX(a5),(a3)+        ; read par port
+         ; Set REQ = 0
+         bclr     d3,(a5)                             ; REQ toggle
+
+         ; Wait RAK == 1
+hwp_WaitRak4:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0
+         bne.s    hwp_RakOk4
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hwp_WaitRak4
+         bra.s    hwp_ExitError
+hwp_RakOk4:
+         ; Read <Size_Lo>
+         move.b   ciaa+ciaprb-BaseAX(a5),(a3)+        ; READCIABYTE
+         ; Set REQ = 1
+         bset     d3,(a5)                             ; REQ toggle
+
+         ; --- check size
+         ; now fetch full size word and check for max frame size
+         move.w   -2(a3),d6                           ; = length
+         tst.w    d6
+         beq.s    hwp_ExitOk                          ; empty size? ok
+         cmp.w    hwb_MaxFrameSize(a2),d6             ; buffer too large
+         bhi.s    hwp_ExitError
+
+         ; only the header is transferred
+         cmp.w    #HWF_PEEKSIZE,d6
+         bls.s    hwp_short
+         moveq    #HWF_PEEKSIZE,d6
+hwp_short:
+         ; convert to words
+         ; (-1 for dbra)
+         btst     #0,d6
+         bne.s    hwp_odd
+         subq.w   #1,d6
+hwp_odd:
+         lsr.w    #1,d6
+
+         ; --- header data loop ---
+         ; -- even bytes: 0,2,4,...
+         ; Wait RAK == 0
+hwp_WaitRak5a:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0                               ; RAK toggled?
+         beq.s    hwp_RakOk5a
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hwp_WaitRak5a
+         bra.s    hwp_ExitError
+hwp_RakOk5a:
+         ; Read <DATA_n>
+         move.b   ciaa+ciaprb-BaseAX(a5),(a3)+        ; read par port byte
+         bclr     d3,(a5)                             ; toggle REQ
+
+         ; -- odd bytes: 1,3,5,...
+         ; Wait RAK == 1
+hwp_WaitRak5b:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0                               ; RAK toggled?
+         bne.s    hwp_RakOk5b
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hwp_WaitRak5b
+         bra.s    hwp_ExitError
+hwp_RakOk5b:
+         ; Read <DATA_n>
+         move.b   ciaa+ciaprb-BaseAX(a5),(a3)+        ; read par port byte
+         bset    d3,(a5)                              ; toggle REQ
+
+         ; loop for all header bytes
+         dbra     d6,hwp_WaitRak5a
+
+hwp_ExitOk:
+         moveq    #TRUE,d5
+hwp_ExitError:
+         ; --- exit ---
+
+         ; reset signal
+         moveq    #0,d0
+         move.l   hwb_IntSigMask(a2),d1
+         JSRLIB   SetSignal
+
+         ; clear RECV_PENDING flag set by irq
+         bclr     #HWB_RECV_PENDING,hwb_Flags(a2)
+
+         ; clear REQ
+         bclr     d3,(a5)
+
+         ; clear SEL
+         CLRSELECT a5
+
+         move.l   d5,d0                               ; return value
+         movem.l  (sp)+,d2-d7/a2-a6
+         rts
+
+;----------------------------------------------------------------------------
+;
+; NAME
+;     hwskip() - drop a peeked packet
+;
+; SYNOPSIS
+;     void hwskip(struct HWBase *)
+;                 A0
+;
+; FUNCTION
+;     Tell the plipbox to drop the packet announced by hwpeek() without
+;     transferring its payload.
+;
+_hwskip:
+         movem.l  d2-d7/a2-a6,-(sp)
+         move.l   a0,a2                               ; a2 = HWBase
+         moveq    #FALSE,d2                           ; d2 = return value
+         move.l   hwb_SysBase(a2),a6                  ; a6 = SysBase
+         moveq    #HS_RAK_BIT,d4                      ; d4 = HS_RAK
+         lea      BaseAX,a5                           ; a5 = CIA HW base
+
+         ; --- prepare
+         ; Wait RAK == 0
+hws_WaitRak1:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0
+         beq.s    hws_RakOk1
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hws_WaitRak1
+         bra.s    hws_ExitError
+hws_RakOk1:
+         ; --- init handshake
+         ; [OUT]
+         SETCIAOUTPUT a5
+
+         ; Set <CMD_RECV_SKIP>
+         move.b   #HWF_CMD_RECV_SKIP,ciaa+ciaprb-BaseAX(a5)
+
+         ; Set SEL = 1 -> Trigger Plipbox
+         SETSELECT a5
+
+         ; --- command confirmed
+         ; Wait RAK == 1
+hws_WaitRak2:
+         move.b   (a5),d0                             ; ciab+ciapra
+         btst     d4,d0
+         bne.s    hws_ExitOk
+         ; check for timeout
+         tst.b    hwb_TimeoutSet(a2)
+         beq.s    hws_WaitRak2
+         bra.s    hws_ExitError
+
+hws_ExitOk:
+         moveq    #TRUE,d2                            ; rc = TRUE
+hws_ExitError:
+         ; --- exit ---
+         ; [IN]
+         SETCIAINPUT a5
+
+         ; reset signal
+         moveq    #0,d0
+         move.l   hwb_IntSigMask(a2),d1
+         JSRLIB   SetSignal
+
+         ; clear RECV_PENDING flag set by irq
+         bclr     #HWB_RECV_PENDING,hwb_Flags(a2)
+
+         ; SEL = 0
+         CLRSELECT a5
+
+         move.l   d2,d0                               ; return rc
+         movem.l  (sp)+,d2-d7/a2-a6
+         rts
+
          end
@@ -31,6 +31,10 @@ HWF_CMD_SEND     equ     $11
 HWF_CMD_RECV     equ     $22
 HWF_CMD_SEND_BURST equ   $33
 HWF_CMD_RECV_BURST equ   $44
+HWF_CMD_RECV_PEEK  equ   $55
+HWF_CMD_RECV_SKIP  equ   $66
+
+HWF_PEEKSIZE     equ     14                 ; header bytes sent by peek
 
 PKTFRAMESIZE_1   equ     4
 PKTFRAMESIZE_2   equ     2
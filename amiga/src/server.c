@@ -53,6 +53,9 @@ typedef enum { AW_OK, AW_BUFFER_ERROR, AW_ERROR } AW_RESULT;
    /* external functions */
 GLOBAL VOID dotracktype(BASEPTR, ULONG type, ULONG ps, ULONG pr, ULONG bs, ULONG br, ULONG pd);
 GLOBAL VOID DevTermIO(BASEPTR, struct IOSana2Req *ios2);
+GLOBAL MC_RESULT addmcast(BASEPTR, UBYTE *addr);
+GLOBAL MC_RESULT remmcast(BASEPTR, UBYTE *addr);
+GLOBAL BOOL sendmcasts(BASEPTR);
 /*E*/
 /*F*/ /* exports */
 PUBLIC VOID SAVEDS ServerTask(void);
@@ -66,6 +69,7 @@ PRIVATE REGARGS BOOL goonline(BASEPTR);
 PRIVATE REGARGS VOID gooffline(BASEPTR);
 PRIVATE REGARGS AW_RESULT write_frame(BASEPTR, struct IOSana2Req *ios2);
 PRIVATE REGARGS VOID dowritereqs(BASEPTR);
+PRIVATE REGARGS BOOL wantframe(BASEPTR, ULONG pkttyp);
 PRIVATE REGARGS VOID doreadreqs(BASEPTR);
 PRIVATE REGARGS VOID dos2reqs(BASEPTR);
 /*E*/
@@ -123,8 +127,9 @@ PRIVATE REGARGS VOID dos2reqs(BASEPTR);
       {
          struct HWBase *hwb = &pb->pb_HWBase;
          
-         /* send magic */
+         /* send magic and restore multicast filter */
          hw_send_magic_pkt(pb, HW_MAGIC_ONLINE);
+         sendmcasts(pb);
 
          GetSysTime(&pb->pb_DevStats.LastStart);
          pb->pb_Flags &= ~PLIPF_OFFLINE;
@@ -287,7 +292,7 @@ PRIVATE REGARGS VOID dos2reqs(BASEPTR);
 PRIVATE REGARGS BOOL read_frame(struct IOSana2Req *req, struct HWFrame *frame)
 {
    int i;
-   BOOL broadcast; 
+   BOOL broadcast, multicast;
    LONG datasize;
    BYTE *frame_ptr;
    struct BufferManagement *bm;
@@ -326,7 +331,8 @@ PRIVATE REGARGS BOOL read_frame(struct IOSana2Req *req, struct HWFrame *frame)
    memcpy(req->ios2_SrcAddr, frame->hwf_SrcAddr, HW_ADDRFIELDSIZE);
    memcpy(req->ios2_DstAddr, frame->hwf_DstAddr, HW_ADDRFIELDSIZE);
    
-   /* need to set broadcast flag? */
+   /* need to set broadcast or multicast flag? */
+   multicast = (frame->hwf_DstAddr[0] & 1) ? TRUE : FALSE;
    broadcast = TRUE;
    for(i=0;i<HW_ADDRFIELDSIZE;i++) {
       if(frame->hwf_DstAddr[i] != 0xff) {
@@ -337,6 +343,9 @@ PRIVATE REGARGS BOOL read_frame(struct IOSana2Req *req, struct HWFrame *frame)
    if(broadcast) {
       req->ios2_Req.io_Flags |= SANA2IOF_BCAST;
    }
+   else if(multicast) {
+      req->ios2_Req.io_Flags |= SANA2IOF_MCAST;
+   }
    
    /* store packet type */
    req->ios2_PacketType = (USHORT)frame->hwf_Type;
@@ -347,17 +356,87 @@ PRIVATE REGARGS BOOL read_frame(struct IOSana2Req *req, struct HWFrame *frame)
    /*
    ** reading packets
    */
+/*F*/ PRIVATE REGARGS BOOL wantframe(BASEPTR, ULONG pkttyp)
+{
+   struct IOSana2Req *got;
+   BOOL want = FALSE;
+
+   /* magic packets are always handled by the server */
+   if ((pkttyp == HW_MAGIC_LOOPBACK) || (pkttyp == HW_MAGIC_ONLINE))
+      return TRUE;
+
+   ObtainSemaphore(&pb->pb_ReadListSem);
+   for(got = (struct IOSana2Req *)pb->pb_ReadList.lh_Head;
+       got->ios2_Req.io_Message.mn_Node.ln_Succ;
+       got = (struct IOSana2Req *)got->ios2_Req.io_Message.mn_Node.ln_Succ )
+   {
+      if (got->ios2_PacketType == pkttyp)
+      {
+         want = TRUE;
+         break;
+      }
+   }
+   ReleaseSemaphore(&pb->pb_ReadListSem);
+
+   return want;
+}
+/*E*/
 /*F*/ PRIVATE REGARGS VOID doreadreqs(BASEPTR)
 {
    LONG datasize;
    struct IOSana2Req *got;
    ULONG pkttyp;
-   BOOL rv;
+   BOOL rv = TRUE;
    struct HWFrame *frame = pb->pb_Frame;
 
-   d8(("+hw_recv\n"));
-   rv = hw_recv_frame(pb, frame);
-   d8(("-hw_recv\n"));
+   /* if nobody waits for orphans then peek at the header first and skip
+   ** unwanted packets without transferring their payload
+   */
+   if (hw_recv_can_peek(pb) && IsListEmpty((struct List *)&pb->pb_ReadOrphanList))
+   {
+      d8(("+hw_peek\n"));
+      rv = hw_recv_peek(pb, frame);
+      d8(("-hw_peek\n"));
+      /* too short for a header: drop it without looking at the type */
+      if (rv && (frame->hwf_Size < HW_ETH_HDR_SIZE))
+      {
+         d8(("Bad peek size (len=%ld)\n", frame->hwf_Size));
+         hw_recv_skip(pb);
+         DoEvent(pb, S2EVENT_HARDWARE | S2EVENT_ERROR | S2EVENT_RX);
+         pb->pb_DevStats.BadData++;
+         return;
+      }
+      if (rv && !wantframe(pb, frame->hwf_Type))
+      {
+         pkttyp = frame->hwf_Type;
+         datasize = frame->hwf_Size - HW_ETH_HDR_SIZE;
+
+         d8(("+hw_skip\n"));
+         rv = hw_recv_skip(pb);
+         d8(("-hw_skip\n"));
+         if (rv)
+         {
+            pb->pb_DevStats.PacketsReceived++;
+            pb->pb_DevStats.UnknownTypesReceived++;
+            dotracktype(pb, pkttyp, 0, 1, 0, datasize, 1);
+            d(("packet %08lx, size %ld skipped\n",pkttyp,datasize));
+         }
+         else
+         {
+            d8(("Error skipping (len=%ld)\n", frame->hwf_Size));
+            DoEvent(pb, S2EVENT_HARDWARE | S2EVENT_ERROR | S2EVENT_RX);
+            pb->pb_DevStats.BadData++;
+         }
+         return;
+      }
+   }
+
+   if (rv)
+   {
+      d8(("+hw_recv\n"));
+      rv = hw_recv_frame(pb, frame);
+      d8(("-hw_recv\n"));
+   }
    if (rv)
    {
       pb->pb_DevStats.PacketsReceived++;
@@ -375,6 +454,7 @@ PRIVATE REGARGS BOOL read_frame(struct IOSana2Req *req, struct HWFrame *frame)
       if(pkttyp == HW_MAGIC_ONLINE) {
          d(("request online magic"));
          hw_send_magic_pkt(pb, HW_MAGIC_ONLINE);
+         sendmcasts(pb);
          return;
       }
 
@@ -512,6 +592,34 @@ PRIVATE REGARGS BOOL read_frame(struct IOSana2Req *req, struct HWFrame *frame)
                ios2->ios2_WireError = S2WERR_GENERIC_ERROR;
             }
          break;
+
+         case S2_ADDMULTICASTADDRESS:
+            switch (addmcast(pb, ios2->ios2_SrcAddr))
+            {
+               case MC_ERROR:
+                  ios2->ios2_Req.io_Error = S2ERR_NO_RESOURCES;
+                  ios2->ios2_WireError = S2WERR_MULTICAST_FULL;
+               break;
+               case MC_CHANGED:
+                  if (!(pb->pb_Flags & PLIPF_OFFLINE))
+                     sendmcasts(pb);
+               break;
+            }
+         break;
+
+         case S2_DELMULTICASTADDRESS:
+            switch (remmcast(pb, ios2->ios2_SrcAddr))
+            {
+               case MC_ERROR:
+                  ios2->ios2_Req.io_Error = S2ERR_BAD_STATE;
+                  ios2->ios2_WireError = S2WERR_BAD_MULTICAST;
+               break;
+               case MC_CHANGED:
+                  if (!(pb->pb_Flags & PLIPF_OFFLINE))
+                     sendmcasts(pb);
+               break;
+            }
+         break;
       }
 
       if (ios2) DevTermIO(pb,ios2);
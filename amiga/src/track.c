@@ -4,16 +4,6 @@
 #include <pragmas/exec_sysbase_pragmas.h>
 #endif
 
-#ifndef EXEC_MEMORY_H
-#include <exec/memory.h>
-#endif
-#ifndef EXEC_LISTS_H
-#include <exec/lists.h>
-#endif
-#ifndef EXEC_NODES_H
-#include <exec/nodes.h>
-#endif
-
 #ifndef _STRING_H
 #include <string.h>
 #endif
@@ -38,15 +28,32 @@ PUBLIC VOID freetracktypes(BASEPTR);
 PRIVATE struct TrackRec *findtracktype(BASEPTR, ULONG type);
 /*E*/
 
+   /*
+   ** track slots are hashed by packet type with linear probing.
+   ** only changing the slot assignment needs pb_TrackListSem: the per
+   ** frame dotracktype() updates the counters without locking.
+   */
+#define TRACK_HASH(type)   (((type) ^ ((type) >> 8)) & (PLIP_TRACKSLOTS - 1))
+#define TRACK_NEXT(slot)   (((slot) + 1) & (PLIP_TRACKSLOTS - 1))
+
 /*F*/ PRIVATE INLINE struct TrackRec *findtracktype(BASEPTR, ULONG type)
 {
    struct TrackRec * tr;
+   ULONG slot = TRACK_HASH(type);
+   UWORD i;
 
-   for (tr = (struct TrackRec *) pb->pb_TrackList.lh_Head; tr->tr_Link.mln_Succ;
-                                                      tr = (struct TrackRec *) tr->tr_Link.mln_Succ)
+   for (i = 0; i < PLIP_TRACKSLOTS; i++)
    {
-      if( tr->tr_PacketType == type )
+      tr = &pb->pb_TrackRecs[slot];
+
+      /* end of probe chain */
+      if (!tr->tr_Used)
+         break;
+
+      if (tr->tr_Count && (tr->tr_PacketType == type))
          return( tr );
+
+      slot = TRACK_NEXT(slot);
    }
 
    return( NULL );
@@ -55,17 +62,28 @@ PRIVATE struct TrackRec *findtracktype(BASEPTR, ULONG type);
 /*F*/ PUBLIC BOOL addtracktype(BASEPTR, ULONG type)
 {
    struct TrackRec *tr;
+   ULONG slot;
+   UWORD i;
    BOOL rv = FALSE;
 
    ObtainSemaphore(&pb->pb_TrackListSem);
    if (!(tr = findtracktype(pb, type)))
    {
-      if (tr = AllocVec(sizeof(*tr), MEMF_CLEAR))
+      /* take first free or untracked slot in probe chain */
+      slot = TRACK_HASH(type);
+      for (i = 0; i < PLIP_TRACKSLOTS; i++)
       {
-         tr->tr_Count = 1;
-         tr->tr_PacketType = type;
-         AddTail((struct List*)&pb->pb_TrackList, (struct Node *)tr);
-         rv = TRUE;
+         tr = &pb->pb_TrackRecs[slot];
+         if (!tr->tr_Count)
+         {
+            memset(&tr->tr_Sana2PacketTypeStats, 0, sizeof(struct Sana2PacketTypeStats));
+            tr->tr_PacketType = type;
+            tr->tr_Used = 1;
+            tr->tr_Count = 1;
+            rv = TRUE;
+            break;
+         }
+         slot = TRACK_NEXT(slot);
       }
    }
    else
@@ -86,11 +104,8 @@ PRIVATE struct TrackRec *findtracktype(BASEPTR, ULONG type);
    ObtainSemaphore( &pb->pb_TrackListSem );
    if (tr = findtracktype(pb, type))
    {
-      if (!(--tr->tr_Count))
-      {
-         Remove((struct Node *)tr);
-         FreeVec(tr);
-      }
+      /* slot stays in use to keep the probe chain */
+      --tr->tr_Count;
       rv = TRUE;
    }
    ReleaseSemaphore( &pb->pb_TrackListSem );
@@ -102,7 +117,6 @@ PRIVATE struct TrackRec *findtracktype(BASEPTR, ULONG type);
 {
    struct TrackRec * tr;
 
-   ObtainSemaphore(&pb->pb_TrackListSem);
    if (tr = findtracktype(pb, type))
    {
       tr->tr_Sana2PacketTypeStats.PacketsSent += ps;
@@ -111,7 +125,6 @@ PRIVATE struct TrackRec *findtracktype(BASEPTR, ULONG type);
       tr->tr_Sana2PacketTypeStats.BytesReceived += br;
       tr->tr_Sana2PacketTypeStats.PacketsDropped += pd;
    }
-   ReleaseSemaphore(&pb->pb_TrackListSem);
 }
 /*E*/
 /*F*/ PUBLIC BOOL gettrackrec(BASEPTR, ULONG type, struct Sana2PacketTypeStats *info)
@@ -132,11 +145,8 @@ PRIVATE struct TrackRec *findtracktype(BASEPTR, ULONG type);
 /*E*/
 /*F*/ PUBLIC VOID freetracktypes(BASEPTR)
 {
-   struct Node *tr;
-
    ObtainSemaphore(&pb->pb_TrackListSem);
-   while(tr = RemHead((struct List*)&pb->pb_TrackList))
-      FreeVec(tr);
+   memset(pb->pb_TrackRecs, 0, sizeof(pb->pb_TrackRecs));
    ReleaseSemaphore(&pb->pb_TrackListSem);
 }
 /*E*/
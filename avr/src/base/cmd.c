@@ -78,8 +78,8 @@ static u08 parse_args(u08 len)
     while(cmd_line[pos] == ' ') {
       pos++;
     }
-    // end reached?
-    if(cmd_line[pos] == '\0') {
+    // end reached? (extra args are ignored)
+    if((cmd_line[pos] == '\0') || (argc == MAX_ARGS)) {
       break;
     }
     // start new arg
@@ -249,6 +249,8 @@ u08 cmd_worker(void)
 
   // small hack to enter commands
   if(uart_read_data_available()) {
+    // interactive output is never dropped
+    u08 old_drop = uart_set_tx_drop(0);
     u08 cmd = uart_read();
     if(cmd == '\n') {
       // enter command loop
@@ -279,6 +281,7 @@ u08 cmd_worker(void)
         result = CMD_WORKER_DONE;
       }
     }
+    uart_set_tx_drop(old_drop);
   }
 
   return result;
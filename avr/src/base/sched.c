@@ -0,0 +1,137 @@
+/*
+ * sched.c - cooperative task scheduler
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "sched.h"
+#include "timer.h"
+#include "uartutil.h"
+#include "uart.h"
+#include "util.h"
+
+static const sched_task_t *sched_tasks;
+static sched_stat_t *sched_stat;
+static u08 sched_num;
+
+void sched_init(const sched_task_t *tasks, sched_stat_t *stat, u08 num)
+{
+  sched_tasks = tasks;
+  sched_stat = stat;
+  sched_num = num;
+
+  u16 now = (u16)time_stamp;
+  for(u08 i=0;i<num;i++) {
+    stat[i].last = now;
+#ifdef DIAG
+    stat[i].cycle = 0;
+    stat[i].max_cycle = 0;
+#endif
+  }
+}
+
+void sched_exit(void)
+{
+  sched_num = 0;
+}
+
+u08 sched_run(void)
+{
+  u08 busy = 0;
+  u16 now = (u16)time_stamp;
+  const sched_task_t *t = sched_tasks;
+  sched_stat_t *s = sched_stat;
+
+  for(u08 i=0;i<sched_num;i++,t++,s++) {
+    u16 wait = now - s->last;
+    u16 period = pgm_read_word(&t->period);
+    if(wait < period) {
+      continue;
+    }
+    // low priority: give way to the busy tasks before, but not for too long
+    u08 flags = pgm_read_byte(&t->flags);
+    if(busy && (flags & SCHED_FLAG_DEFER) && (wait < (period << 1))) {
+      continue;
+    }
+
+#ifdef DIAG
+    s->cycle = wait;
+    if(wait > s->max_cycle) {
+      s->max_cycle = wait;
+    }
+#endif
+    s->last = now;
+
+    sched_func_t func = (sched_func_t)pgm_read_word(&t->func);
+    if(func()) {
+      busy = 1;
+    }
+  }
+  return busy;
+}
+
+#ifdef DIAG
+
+void sched_reset(void)
+{
+  for(u08 i=0;i<sched_num;i++) {
+    sched_stat[i].max_cycle = 0;
+  }
+}
+
+static void send_ms(u16 val)
+{
+  u08 buf[7];
+  dword_to_dec(val, buf, 5, 1);
+  uart_send_data(buf, 6);
+}
+
+void sched_dump(void)
+{
+  if(sched_num == 0) {
+    return;
+  }
+  uart_send_pstring(PSTR("cycle  max    task (ms)\r\n"));
+  const sched_task_t *t = sched_tasks;
+  const sched_stat_t *s = sched_stat;
+  for(u08 i=0;i<sched_num;i++,t++,s++) {
+    send_ms(s->cycle);
+    uart_send_spc();
+    send_ms(s->max_cycle);
+    uart_send_spc();
+    uart_send_pstring((PGM_P)pgm_read_word(&t->name));
+    uart_send_crlf();
+  }
+}
+
+#else
+
+void sched_reset(void)
+{
+}
+
+void sched_dump(void)
+{
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * sched.h - cooperative task scheduler
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "global.h"
+
+/*
+ * tasks are called in the order of the table, i.e. the first task has
+ * the highest priority. a task returns 1 if it did some work.
+ */
+typedef u08 (*sched_func_t)(void);
+
+// wait while a task before this one is busy (at most two periods)
+#define SCHED_FLAG_DEFER    1
+
+struct sched_task_s {
+  sched_func_t func;
+  const char * name;    // in flash
+  u16          period;  // run at most every period * 100us. 0=every pass
+  u08          flags;
+};
+typedef struct sched_task_s sched_task_t;
+
+// run time state of a task (times in 100us)
+typedef struct {
+  u16 last;       // start of last run
+#ifdef DIAG
+  u16 cycle;      // time between the last two runs
+  u16 max_cycle;
+#endif
+} sched_stat_t;
+
+// tasks is a table in flash
+extern void sched_init(const sched_task_t *tasks, sched_stat_t *stat, u08 num);
+extern void sched_exit(void);
+// one pass over all tasks. returns 1 if a task did some work
+extern u08 sched_run(void);
+
+extern void sched_reset(void);
+// dump cycle times (only with DIAG). nothing is shown if no scheduler is active
+extern void sched_dump(void);
+
+#endif
@@ -33,6 +33,10 @@ volatile u16 timer_100us = 0;
 volatile u16 timer_10ms = 0;
 volatile u32 time_stamp = 0;
 static u16 count;
+#ifdef DIAG
+volatile u16 timer_1s = 0;
+static u16 count_1s;
+#endif
 
 void timer_init(void)
 {
@@ -77,6 +81,7 @@ void timer_init(void)
   // ----- TIMER1 (16bit) -----
   // prescale 64 
   // 16 MHz -> 250 KHz = 4 us timer
+  // 20 MHz -> 312.5 KHz = 3.2 us timer
   
   // set to CTC on OCR1A with prescale 8
   TCCR1A = 0x00;
@@ -92,6 +97,10 @@ void timer_init(void)
   timer_10ms = 0;
   time_stamp = 0;
   count = 0;
+#ifdef DIAG
+  timer_1s = 0;
+  count_1s = 0;
+#endif
 
   sei();
 }
@@ -110,6 +119,13 @@ ISR(TIMER2_COMP_vect)
     count = 0;
     timer_10ms++;
   }
+#ifdef DIAG
+  count_1s++;
+  if(count_1s == 10000) {
+    count_1s = 0;
+    timer_1s++;
+  }
+#endif
 } 
 
 void timer_delay_10ms(u16 timeout)
@@ -123,8 +139,9 @@ void timer_delay_100us(u16 timeout)
 u16 timer_hw_calc_rate_kbs(u16 bytes, u16 delta)
 {
   if(delta != 0) {
-    u32 nom = 1000 * (u32)bytes * 100;
-    u32 denom = (u32)delta * 4; 
+    // delta is in 64 / F_CPU s
+    u32 nom = (u32)bytes * (F_CPU / 640);
+    u32 denom = delta;
     u32 rate = nom / denom;
     return (u16)rate;
   } else {
@@ -45,6 +45,12 @@ extern volatile u16 timer_100us;
 // in 100us
 extern volatile u32 time_stamp;
 
+#ifdef DIAG
+// seconds since timer_init() (for the rate windows)
+// 16bit: 0,1s...~18hours
+extern volatile u16 timer_1s;
+#endif
+
 // busy wait with 10ms timer
 extern void timer_delay_10ms(u16 timeout);
 
@@ -53,11 +59,14 @@ extern void timer_delay_100us(u16 timeout);
 
 // ----- hardware timer -----
 
-// 16 bit hw timer with 4us resolution
+// 16 bit hw timer with 64 / F_CPU resolution (4us at 16 MHz, 3.2us at 20 MHz)
 inline void timer_hw_reset(void) { TCNT1 = 0; }
 inline u16  timer_hw_get(void) { return TCNT1; }
 extern u16 timer_hw_calc_rate_kbs(u16 bytes, u16 delta);
 
+// hw timer ticks to us
+#define TIMER_HW_TICKS_TO_US(t)   ((u32)(t) * 64000 / (F_CPU / 1000))
+
   
 #endif
 
@@ -42,6 +42,7 @@
 #define UCSRB  UCSR0B
 #define UCSRC  UCSR0C
 #define UDRE   UDRE0
+#define UDRIE  UDRIE0
 #define UDR    UDR0
 
 #define RXC    RXC0
@@ -49,10 +50,15 @@
 #define DOR    DOR0
 #define PE     UPE0
 
+// no URSEL bit: 8 bit, 1 stop, no parity, asynch. mode
+#define UART_UCSRC  0x06
+#else
+// 0x86 -> use UCSRC, 8 bit, 1 stop, no parity, asynch. mode
+#define UART_UCSRC  0x86
 #endif
 
-// calc ubbr from baud rate
-#define UART_UBRR   F_CPU/16/UART_BAUD-1
+// calc ubbr from baud rate (rounded)
+#define UART_UBRR   ((F_CPU + UART_BAUD * 8L) / (16L * UART_BAUD) - 1)
 
 #define UART_RX_BUF_SIZE 16
 #define UART_RX_SET_CTS_POS  2
@@ -62,6 +68,30 @@ static volatile u08 uart_rx_start = 0;
 static volatile u08 uart_rx_end = 0;
 static volatile u08 uart_rx_size = 0;
 
+// tx ring drained by the UDRE interrupt. size must be a power of 2
+#ifdef DIAG
+#define UART_TX_BUF_SIZE 64
+#else
+#define UART_TX_BUF_SIZE 8
+#endif
+#define UART_TX_BUF_MASK (UART_TX_BUF_SIZE - 1)
+static volatile u08 uart_tx_buf[UART_TX_BUF_SIZE];
+static volatile u08 uart_tx_start = 0;
+static volatile u08 uart_tx_end = 0;
+
+#ifdef DIAG
+static u08 uart_tx_drop = 0;
+static u16 uart_tx_drops = 0;
+
+// in tx drop mode a line is sent as a whole or not at all: it starts only
+// with this much room in the ring. longer lines may wait for the rest
+#define UART_TX_LINE_ROOM  (UART_TX_BUF_SIZE - 16)
+#define UART_TX_LINE_START  0
+#define UART_TX_LINE_SEND   1
+#define UART_TX_LINE_DROP   2
+static u08 uart_tx_line = UART_TX_LINE_START;
+#endif
+
 void uart_init(void) 
 {
   cli();
@@ -74,18 +104,28 @@ void uart_init(void)
   UBRRL = (u08)((UART_UBRR)&0xff);
 
   UCSRB = 0x98; // 0x18  enable tranceiver and transmitter, RX interrupt
-  UCSRC = 0x86; // 0x86 -> use UCSRC, 8 bit, 1 stop, no parity, asynch. mode
+  UCSRC = UART_UCSRC;
 
   sei();
 
   uart_rx_start = 0;
   uart_rx_end = 0;
   uart_rx_size = 0;
+
+  uart_tx_start = 0;
+  uart_tx_end = 0;
+#ifdef DIAG
+  uart_tx_drop = 0;
+  uart_tx_drops = 0;
+  uart_tx_line = UART_TX_LINE_START;
+#endif
 }
 
 // receiver interrupt
-#ifdef USART_RXC_vect
+#if defined(USART_RXC_vect)
 ISR(USART_RXC_vect)
+#elif defined(USART0_RX_vect)
+ISR(USART0_RX_vect)
 #else
 ISR(USART_RX_vect)
 #endif
@@ -125,12 +165,111 @@ u08 uart_read(void)
   return data;
 }
 
+// transmitter interrupt: next byte of ring or disable itself
+#ifdef USART0_UDRE_vect
+ISR(USART0_UDRE_vect)
+#else
+ISR(USART_UDRE_vect)
+#endif
+{
+  u08 start = uart_tx_start;
+  if(start == uart_tx_end) {
+    UCSRB &= ~(1<<UDRIE);
+  } else {
+    UDR = uart_tx_buf[start];
+    uart_tx_start = (start + 1) & UART_TX_BUF_MASK;
+  }
+}
+
 void uart_send(u08 data)
 {
-  // wait for transmitter to become ready
-  while(!( UCSRA & (1<<UDRE)));
+  u08 end = uart_tx_end;
+  u08 next = (end + 1) & UART_TX_BUF_MASK;
+
+#ifdef DIAG
+  // drop mode: decide on the whole line with its first byte
+  u08 line = uart_tx_line;
+  if(line == UART_TX_LINE_START) {
+    line = UART_TX_LINE_SEND;
+    if(uart_tx_drop) {
+      u08 free = (uart_tx_start - end - 1) & UART_TX_BUF_MASK;
+      if(free < UART_TX_LINE_ROOM) {
+        line = UART_TX_LINE_DROP;
+        uart_tx_drops++;
+      }
+    }
+  }
+  uart_tx_line = (data == '\n') ? UART_TX_LINE_START : line;
+  if(line == UART_TX_LINE_DROP) {
+    return;
+  }
+#endif
+
+  // ring is full
+  while(next == uart_tx_start) {
+    // no interrupts (e.g. in a burst): drain the ring by hand
+    if(!(SREG & (1<<SREG_I)) && (UCSRA & (1<<UDRE))) {
+      u08 start = uart_tx_start;
+      UDR = uart_tx_buf[start];
+      uart_tx_start = (start + 1) & UART_TX_BUF_MASK;
+    }
+  }
+
+  uart_tx_buf[end] = data;
+  uart_tx_end = next;
+
+  // (re-)enable transmitter interrupt
+  UCSRB |= (1<<UDRIE);
+}
+
+u08 uart_send_nb(const u08 *data, u08 size)
+{
+  u08 end = uart_tx_end;
+  u08 free = (uart_tx_start - end - 1) & UART_TX_BUF_MASK;
+  if(size > free) {
+    return 0;
+  }
+
+  for(u08 i=0;i<size;i++) {
+    uart_tx_buf[end] = data[i];
+    end = (end + 1) & UART_TX_BUF_MASK;
+  }
+  uart_tx_end = end;
+
+  UCSRB |= (1<<UDRIE);
+  return 1;
+}
+
+#ifdef DIAG
+
+u08 uart_set_tx_drop(u08 on)
+{
+  u08 old = uart_tx_drop;
+  uart_tx_drop = on;
+  // output in normal mode is never lost
+  if(!on && (uart_tx_line == UART_TX_LINE_DROP)) {
+    uart_tx_line = UART_TX_LINE_START;
+  }
+  return old;
+}
+
+u16 uart_get_tx_drops(void)
+{
+  return uart_tx_drops;
+}
+
+#else
+
+// no drop mode: the small ring always waits for room
+u08 uart_set_tx_drop(u08 on)
+{
+  return 0;
+}
 
-  // send byte
-  UDR = data;
+u16 uart_get_tx_drops(void)
+{
+  return 0;
 }
 
+#endif
+
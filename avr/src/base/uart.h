@@ -39,6 +39,17 @@ u08 uart_read_data_available(void);
 u08 uart_read(void);
 
 // write a byte (with rts handshaking)
+// the byte is queued and sent by the transmitter interrupt. if the queue
+// is full then wait for room. in tx drop mode a line that does not fit is
+// dropped as a whole
 void uart_send(u08 data);
 
+// queue all bytes or none of them without waiting. returns 1 if queued
+u08 uart_send_nb(const u08 *data, u08 size);
+
+// enable/disable tx drop mode (returns old state). only with DIAG
+u08 uart_set_tx_drop(u08 on);
+// number of lines dropped in tx drop mode
+u16 uart_get_tx_drops(void);
+
 #endif
@@ -134,6 +134,8 @@ void uart_send_free_stack(void)
   u16 free = stack_free();
   uart_send_pstring(PSTR("free stack:"));
   uart_send_hex_word(free);
+  uart_send_pstring(PSTR(" unused:"));
+  uart_send_hex_word(stack_unused());
   uart_send_crlf();
 }
 #endif
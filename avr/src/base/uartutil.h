@@ -56,7 +56,7 @@ void uart_send_hex_word(u16 data);
 void uart_send_hex_dword(u32 data); 
 
 #ifdef DEBUG
-// send free stack
+// send free stack and the part never used since reset
 void uart_send_free_stack(void);
 #endif
 
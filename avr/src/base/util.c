@@ -165,3 +165,32 @@ u08 parse_byte_dec(const u08 *buf, u08 *out)
   }
   return digits;
 }
+
+#ifdef DEBUG
+
+#define STACK_PAINT  0xc5
+
+// fill the free SRAM with a pattern before the stack is used (after .init2
+// set the stack pointer and before the variables are set up)
+void stack_paint(void) __attribute__ ((naked, used, section (".init3")));
+void stack_paint(void)
+{
+  u08 *p = (u08 *)&__heap_start;
+  while(p < (u08 *)SP) {
+    *p = STACK_PAINT;
+    p++;
+  }
+}
+
+u16 stack_unused(void)
+{
+  const u08 *p = (const u08 *)&__heap_start;
+  u16 n = 0;
+  while((p < (const u08 *)SP) && (*p == STACK_PAINT)) {
+    p++;
+    n++;
+  }
+  return n;
+}
+
+#endif
@@ -62,6 +62,8 @@ extern u08 parse_byte_dec(const u08 *buf, u08 *out);
 // ---- stack free -----
 extern void *__heap_start;
 inline u16 stack_free(void) { return SP - (u16) &__heap_start; }
+// bytes of the stack never touched since reset (high-water mark)
+extern u16 stack_unused(void);
 #endif
 
 #endif
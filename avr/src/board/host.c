@@ -0,0 +1,68 @@
+/*
+ * host.c - board init of the host build
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "global.h"
+#include "board.h"
+#include "par_sim.h"
+
+par_sim_t *par_sim;
+u08 par_sim_dummy;
+
+void board_init(void)
+{
+  if(par_sim != NULL) {
+    return;
+  }
+
+  // map the simulated parallel port
+  const char *name = getenv("PLIPBOX_SHM");
+  if(name == NULL) {
+    name = PAR_SIM_SHM_NAME;
+  }
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+  if(fd < 0) {
+    perror("shm_open");
+    exit(1);
+  }
+  if(ftruncate(fd, sizeof(par_sim_t)) < 0) {
+    perror("ftruncate");
+    exit(1);
+  }
+  void *ptr = mmap(NULL, sizeof(par_sim_t), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+  close(fd);
+  if(ptr == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+  par_sim = (par_sim_t *)ptr;
+}
@@ -29,6 +29,7 @@
 #include "pkt_buf.h"
 #include "pb_proto.h"
 #include "uartutil.h"
+#include "uart.h"
 #include "param.h"
 #include "dump.h"
 #include "timer.h"
@@ -37,11 +38,17 @@
 #include "bridge.h"
 #include "main.h"
 #include "cmd.h"
+#include "sched.h"
 #include "pb_util.h"
 #include "pio_util.h"
 #include "pio.h"
+#include "trace.h"
 #include "net/eth.h"
 #include "net/net.h"
+#include "net/arp.h"
+#include "net/ip.h"
+#include "net/tcp.h"
+#include "net/udp.h"
 
 #define FLAG_ONLINE         1
 #define FLAG_SEND_MAGIC     2
@@ -50,6 +57,13 @@
 static u08 flags;
 static u08 req_is_pending;
 
+// IP address of the Amiga learned from its outgoing frames
+static u08 amiga_ip[4];
+static u08 amiga_ip_valid;
+
+// buffer slot of the plipbox transfers
+static u08 work_slot;
+
 static void trigger_request(void)
 {
   if(!req_is_pending) {
@@ -60,6 +74,9 @@ static void trigger_request(void)
       uart_send_pstring(PSTR("REQ\r\n"));
     }
   } else {
+    if(global_trace) {
+      trace_event(TRACE_EV_PB_REQ_IGN, 0, 0, 0);
+    }
     if(global_verbose) {
       uart_send_time_stamp_spc();
       uart_send_pstring(PSTR("req ign\r\n"));
@@ -67,6 +84,78 @@ static void trigger_request(void)
   }
 }
 
+// ----- frame ring -----
+
+#if PKT_BUF_NUM > 1
+// frames read ahead from the device. keep a slot for the Amiga side
+#define RX_AHEAD    (PKT_BUF_NUM - 2)
+
+// frames of the device waiting for the Amiga
+static pkt_queue_t rx_queue;
+// frames of the Amiga waiting for the device
+static pkt_queue_t tx_queue;
+
+static void ring_init(void)
+{
+  pkt_buf_reset();
+  pkt_queue_init(&rx_queue);
+  pkt_queue_init(&tx_queue);
+}
+
+// transfer the next plipbox frame with the buffer of the given slot
+static void set_work_slot(u08 slot)
+{
+  work_slot = slot;
+  pb_proto_set_buf(pkt_buf_get(slot));
+}
+
+// is the device still sending the last frame?
+static u08 tx_busy(void)
+{
+  u08 val;
+  return (pio_status(PIO_STATUS_TX_BUSY, &val) == PIO_OK) && val;
+}
+
+// send all waiting frames of the Amiga
+static void flush_tx(void)
+{
+  u16 size;
+  u08 slot;
+  while((slot = pkt_queue_get(&tx_queue, &size)) != PKT_BUF_NONE) {
+    pio_util_send(pkt_buf_get(slot), size);
+    pkt_buf_free(slot);
+  }
+}
+
+// read the pending device frame into a free slot
+static void prefetch_pkt(void)
+{
+  u08 slot = pkt_buf_alloc();
+  if(slot == PKT_BUF_NONE) {
+    return;
+  }
+  u16 size;
+  if(pio_util_recv(pkt_buf_get(slot), &size) != PIO_OK) {
+    pkt_buf_free(slot);
+    return;
+  }
+  pkt_queue_put(&rx_queue, slot, size);
+}
+#endif
+
+// going offline: the read ahead frames are lost
+static void drop_queue(void)
+{
+#if PKT_BUF_NUM > 1
+  u16 size;
+  u08 slot;
+  while((slot = pkt_queue_get(&rx_queue, &size)) != PKT_BUF_NONE) {
+    pkt_buf_free(slot);
+    stats_get(STATS_ID_PIO_RX)->drop++;
+  }
+#endif
+}
+
 // ----- magic packets -----
 
 static void magic_online(const u08 *buf)
@@ -74,6 +163,8 @@ static void magic_online(const u08 *buf)
   uart_send_time_stamp_spc();
   uart_send_pstring(PSTR("[MAGIC] online\r\n"));
   flags |= FLAG_ONLINE | FLAG_FIRST_TRANSFER;
+  // a peek of the last session is never answered
+  pb_proto_clear_peek();
 
   // validate mac address and if it does not match then reconfigure PIO
   const u08 *src_mac = eth_get_src_mac(buf);
@@ -85,6 +176,7 @@ static void magic_online(const u08 *buf)
     // re-configure PIO
     pio_exit();
     pio_init(param.mac_addr, PIO_INIT_BROAD_CAST);
+    pio_util_apply_param();
   }
 }
 
@@ -93,6 +185,9 @@ static void magic_offline(void)
   uart_send_time_stamp_spc();
   uart_send_pstring(PSTR("[MAGIC] offline\r\n"));
   flags &= ~FLAG_ONLINE;
+  amiga_ip_valid = 0;
+  pb_proto_clear_peek();
+  drop_queue();
 }
 
 static void magic_loopback(u16 size)
@@ -101,6 +196,31 @@ static void magic_loopback(u16 size)
   trigger_request();
 }
 
+static void magic_mcast(const u08 *buf, u16 size)
+{
+  // payload: address count word followed by the 6 byte addresses
+  const u08 *data = buf + ETH_HDR_SIZE;
+  u16 num = 0;
+  if(size >= (ETH_HDR_SIZE + 2)) {
+    num = net_get_word(data);
+  }
+
+  // too many or truncated list: open the filter for all multicasts
+  u08 pio_num;
+  if((num > PIO_MCAST_MAX) || (size < (ETH_HDR_SIZE + 2 + num * 6))) {
+    pio_num = PIO_MCAST_ALL;
+  } else {
+    pio_num = (u08)num;
+  }
+
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[MAGIC] mcast "));
+  uart_send_hex_byte(pio_num);
+  uart_send_crlf();
+
+  pio_set_mcast(data + 2, pio_num);
+}
+
 static void request_magic(void)
 {
   uart_send_time_stamp_spc();
@@ -111,6 +231,200 @@ static void request_magic(void)
   trigger_request();
 }
 
+// ----- Amiga IP -----
+
+// learn the address from the outgoing frames of the Amiga
+static void learn_ip(const u08 *buf, u16 size)
+{
+  const u08 *ip;
+  u16 type = eth_get_pkt_type(buf);
+  if((type == ETH_TYPE_IPV4) && (size >= (ETH_HDR_SIZE + IP_MIN_HDR_SIZE))) {
+    ip = ip_get_src_ip(buf + ETH_HDR_SIZE);
+  }
+  else if((type == ETH_TYPE_ARP) && (size > ETH_HDR_SIZE) &&
+          arp_is_ipv4(buf + ETH_HDR_SIZE, size - ETH_HDR_SIZE)) {
+    ip = arp_get_src_ip(buf + ETH_HDR_SIZE);
+  }
+  else {
+    return;
+  }
+
+  // no address yet (DHCP or ARP probe)
+  if(net_compare_ip(ip, net_zero_ip)) {
+    return;
+  }
+  if(amiga_ip_valid && net_compare_ip(ip, amiga_ip)) {
+    return;
+  }
+
+  net_copy_ip(ip, amiga_ip);
+  amiga_ip_valid = 1;
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[ARP] amiga ip "));
+  net_dump_ip(amiga_ip);
+  uart_send_crlf();
+}
+
+// ----- proxy ARP -----
+
+// answer an ARP request for the Amiga without a transfer to the Amiga.
+// buf holds the head of the pending pio packet of the given size.
+// returns 1 if the packet was consumed
+static u08 proxy_arp(u08 *buf, u16 size)
+{
+  u08 *arp = buf + ETH_HDR_SIZE;
+
+  if((size < (ETH_HDR_SIZE + ARP_SIZE)) || !eth_is_arp_pkt(buf)) {
+    return 0;
+  }
+  if(!arp_is_ipv4(arp, ARP_SIZE) || (arp_get_op(arp) != ARP_REQUEST)) {
+    return 0;
+  }
+  if(!net_compare_ip(arp_get_tgt_ip(arp), amiga_ip)) {
+    return 0;
+  }
+
+  // gratuitous ARP, probes and address conflicts are left to the Amiga
+  const u08 *src_ip = arp_get_src_ip(arp);
+  if(net_compare_ip(src_ip, amiga_ip) || net_compare_ip(src_ip, net_zero_ip)) {
+    return 0;
+  }
+
+  // consume request (a padded frame is cut to the ARP size)
+  u08 result = pio_recv(buf, ETH_HDR_SIZE + ARP_SIZE, &size);
+  if((result != PIO_OK) && (result != PIO_TOO_LARGE)) {
+    return 1;
+  }
+
+  arp_make_reply(arp, param.mac_addr, amiga_ip);
+  net_copy_mac(buf + ETH_OFF_SRC_MAC, buf + ETH_OFF_TGT_MAC);
+  net_copy_mac(param.mac_addr, buf + ETH_OFF_SRC_MAC);
+  pio_send(buf, ETH_HDR_SIZE + ARP_SIZE);
+
+  stats_count(STATS_CNT_ARP_PROXY);
+  if(global_trace) {
+    trace_event(TRACE_EV_ARP_PROXY, size, result, 0);
+  }
+  if(global_verbose) {
+    uart_send_time_stamp_spc();
+    uart_send_pstring(PSTR("ARP proxy: "));
+    net_dump_ip(arp_get_tgt_ip(arp));
+    uart_send_crlf();
+  }
+  return 1;
+}
+
+// ----- broadcast filter -----
+
+// does the Amiga need this broadcast?
+static u08 is_wanted_bcast(const u08 *buf, u16 size)
+{
+  const u08 *pl = buf + ETH_HDR_SIZE;
+  u16 type = eth_get_pkt_type(buf);
+
+  // ARP only for the Amiga. without its address it has to see all
+  if(type == ETH_TYPE_ARP) {
+    if(!amiga_ip_valid) {
+      return 1;
+    }
+    return (size >= (ETH_HDR_SIZE + ARP_SIZE)) && arp_is_ipv4(pl, ARP_SIZE) &&
+           net_compare_ip(arp_get_tgt_ip(pl), amiga_ip);
+  }
+
+  // UDP: DHCP replies and the configured ports
+  if((type == ETH_TYPE_IPV4) && (size >= (ETH_HDR_SIZE + IP_MIN_HDR_SIZE)) &&
+     (ip_get_protocol(pl) == IP_PROTOCOL_UDP) &&
+     (ip_get_frag_offset(pl) == 0)) {
+    u08 hdr_size = ip_get_hdr_length(pl);
+    if((hdr_size < IP_MIN_HDR_SIZE) ||
+       (size < (ETH_HDR_SIZE + hdr_size + UDP_DATA_OFF))) {
+      return 0;
+    }
+    u16 port = udp_get_tgt_port(pl + hdr_size);
+    if(port == UDP_PORT_DHCP_CLIENT) {
+      return 1;
+    }
+    for(u08 i=0;i<PARAM_BCAST_PORTS;i++) {
+      if((port != 0) && (port == param.bcast_port[i])) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+// eth header, IP header with options and UDP header
+#define PEEK_SIZE   (ETH_HDR_SIZE + 60 + UDP_DATA_OFF)
+
+// handle the pending pio packet in the firmware if possible:
+// answer ARP for the Amiga or drop broadcasts of no interest.
+// buf is an idle frame buffer to look at the packet head.
+// returns 1 if the packet was consumed
+static u08 filter_pkt(u08 *buf)
+{
+  u16 size;
+
+  // look at the head of the packet only
+  if(pio_peek(buf, PEEK_SIZE, &size) != PIO_OK) {
+    return 0;
+  }
+
+  if(param.proxy_arp && amiga_ip_valid && proxy_arp(buf, size)) {
+    return 1;
+  }
+
+  if(!param.bcast_filter || !net_compare_bcast_mac(eth_get_tgt_mac(buf))) {
+    return 0;
+  }
+  if(is_wanted_bcast(buf, size)) {
+    stats_count(STATS_CNT_BCAST_PASS);
+    return 0;
+  }
+
+  u16 type = eth_get_pkt_type(buf);
+  u08 result = pio_recv(buf, PEEK_SIZE, &size);
+  stats_count(STATS_CNT_BCAST_DROP);
+  if(global_trace) {
+    trace_event(TRACE_EV_BCAST_DROP, size, result, 0);
+  }
+  if(global_verbose) {
+    uart_send_time_stamp_spc();
+    uart_send_pstring(PSTR("bcast drop: type="));
+    uart_send_hex_word(type);
+    uart_send_crlf();
+  }
+  return 1;
+}
+
+// ----- MSS clamping -----
+
+// limit the MSS of TCP connections in both directions to param.mss_clamp
+static void clamp_mss(u08 *buf, u16 size)
+{
+  if(!eth_is_ipv4_pkt(buf) || (size < (ETH_HDR_SIZE + IP_MIN_HDR_SIZE))) {
+    return;
+  }
+  u08 *ip_buf = buf + ETH_HDR_SIZE;
+  if((ip_get_protocol(ip_buf) != IP_PROTOCOL_TCP) ||
+     (ip_get_frag_offset(ip_buf) != 0)) {
+    return;
+  }
+  u08 hdr_size = ip_get_hdr_length(ip_buf);
+  u16 ip_size = ip_get_total_length(ip_buf);
+  if((hdr_size < IP_MIN_HDR_SIZE) || (ip_size < hdr_size) ||
+     (ip_size > (size - ETH_HDR_SIZE))) {
+    return;
+  }
+
+  if(tcp_clamp_mss(ip_buf + hdr_size, ip_size - hdr_size, param.mss_clamp)) {
+    stats_count(STATS_CNT_MSS_CLAMP);
+    if(global_verbose) {
+      uart_send_time_stamp_spc();
+      uart_send_pstring(PSTR("MSS clamp\r\n"));
+    }
+  }
+}
+
 // ----- packet callbacks -----
 
 // the Amiga requests a new packet
@@ -121,14 +435,30 @@ static u08 fill_pkt(u08 *buf, u16 max_size, u16 *size)
     flags &= ~FLAG_SEND_MAGIC;
 
     // build magic packet
-    net_copy_bcast_mac(pkt_buf + ETH_OFF_TGT_MAC);
-    net_copy_mac(param.mac_addr, pkt_buf + ETH_OFF_SRC_MAC);
-    net_put_word(pkt_buf + ETH_OFF_TYPE, ETH_TYPE_MAGIC_ONLINE);
+    net_copy_bcast_mac(buf + ETH_OFF_TGT_MAC);
+    net_copy_mac(param.mac_addr, buf + ETH_OFF_SRC_MAC);
+    net_put_word(buf + ETH_OFF_TYPE, ETH_TYPE_MAGIC_ONLINE);
 
     *size = ETH_HDR_SIZE;
   } else {
-    // pending PIO packet?
-    pio_util_recv_packet(size);
+#if PKT_BUF_NUM > 1
+    // read ahead frame? its slot becomes the transfer buffer
+    u08 slot = pkt_queue_get(&rx_queue, size);
+    if(slot != PKT_BUF_NONE) {
+      pkt_buf_free(work_slot);
+      set_work_slot(slot);
+      if(param.mss_clamp) {
+        clamp_mss(pkt_buf_get(slot), *size);
+      }
+    } else
+#endif
+    {
+      // pending PIO packet?
+      u08 result = pio_util_recv(buf, size);
+      if((result == PIO_OK) && param.mss_clamp) {
+        clamp_mss(buf, *size);
+      }
+    }
 
     // report first packet transfer
     if(flags & FLAG_FIRST_TRANSFER) {
@@ -143,11 +473,33 @@ static u08 fill_pkt(u08 *buf, u16 max_size, u16 *size)
   return PBPROTO_STATUS_OK;  
 }
 
+// send a frame of the Amiga. with a free slot it waits there while the
+// device is busy and the Amiga goes on with the next one
+static void send_pkt(const u08 *buf, u16 size)
+{
+#if PKT_BUF_NUM > 1
+  if((tx_queue.num > 0) || tx_busy()) {
+    u08 slot = pkt_buf_alloc();
+    if(slot != PKT_BUF_NONE) {
+      pkt_queue_put(&tx_queue, work_slot, size);
+      set_work_slot(slot);
+      return;
+    }
+    // keep the order of the frames
+    flush_tx();
+  }
+#endif
+  pio_util_send(buf, size);
+}
+
 // handle incoming packet from Amiga
 static u08 proc_pkt(const u08 *buf, u16 size)
 {
   // get eth type
   u16 eth_type = eth_get_pkt_type(buf);
+  if(global_trace && (eth_type >= ETH_TYPE_MAGIC_MCAST)) {
+    trace_event(TRACE_EV_MAGIC, eth_type, 0, 0);
+  }
   switch(eth_type) {
     case ETH_TYPE_MAGIC_ONLINE:
       magic_online(buf);
@@ -158,9 +510,16 @@ static u08 proc_pkt(const u08 *buf, u16 size)
     case ETH_TYPE_MAGIC_LOOPBACK:
       magic_loopback(size);
       break;
+    case ETH_TYPE_MAGIC_MCAST:
+      magic_mcast(buf, size);
+      break;
     default:
+      learn_ip(buf, size);
+      if(param.mss_clamp) {
+        clamp_mss(pkt_buf_get(work_slot), size);
+      }
       // send packet via pio
-      pio_util_send_packet(size);
+      send_pkt(buf, size);
       // if a packet arrived and we are not online then request online state
       if((flags & FLAG_ONLINE)==0) {
         request_magic();
@@ -170,96 +529,269 @@ static u08 proc_pkt(const u08 *buf, u16 size)
   return PBPROTO_STATUS_OK;
 }
 
+// ----- flow control -----
+
+static u08 flow_paused;
+#ifdef DIAG
+static u32 flow_pause_ts;
+#endif
+
+static void flow_set(u08 on)
+{
+  pio_control(PIO_CONTROL_FLOW, on);
+  flow_paused = on;
+#ifdef DIAG
+  if(on) {
+    stats_count(STATS_CNT_FLOW_PAUSE);
+    flow_pause_ts = time_stamp;
+  } else {
+    stats_flow_time += time_stamp - flow_pause_ts;
+  }
+#endif
+  if(global_verbose) {
+    uart_send_time_stamp_spc();
+    uart_send_pstring(on ? PSTR("FLOW on\r\n") : PSTR("FLOW off\r\n"));
+  }
+}
+
+// pause the sender if the free space of the rx buffer falls below the
+// pause watermark and let it go on above the resume watermark
+static void flow_update(u08 n)
+{
+  u16 free;
+  u08 val;
+  if(n == 0) {
+    free = 0xffff;
+  }
+  else if(pio_status(PIO_STATUS_RX_FREE, &val) == PIO_OK) {
+    free = (u16)val << PIO_RX_FREE_SHIFT;
+  }
+  else {
+    // device does not know its fill level: pause on a second packet and
+    // keep the state until all are gone
+    free = (n > 1) ? 0 : param.flow_pause;
+  }
+
+  if(flow_paused) {
+    if(free >= param.flow_resume) {
+      flow_set(0);
+    }
+  }
+  else if(free < param.flow_pause) {
+    flow_set(1);
+  }
+}
+
+// ---------- tasks ----------
+
+static u08 cmd_result;
+static u08 pio_pending;
+static u08 flow_control;
+static u08 first;
+
+// plipbox protocol: the Amiga must never wait for us
+static u08 task_pb(void)
+{
+  return pb_util_handle() != PBPROTO_STATUS_IDLE;
+}
+
+#if PKT_BUF_NUM > 1
+// read ahead device frames while the Amiga is busy with the last one
+static void fetch_pkts(u08 n)
+{
+  if((n > 0) && (rx_queue.num < RX_AHEAD)) {
+    // the frame of a pending request must reach the Amiga
+    u08 done = 0;
+    if((!req_is_pending || (rx_queue.num > 0)) &&
+       (param.proxy_arp || param.bcast_filter)) {
+      // the work slot may hold a peeked frame: look with a free one
+      u08 slot = pkt_buf_alloc();
+      if(slot != PKT_BUF_NONE) {
+        done = filter_pkt(pkt_buf_get(slot));
+        pkt_buf_free(slot);
+      }
+    }
+    if(!done) {
+      prefetch_pkt();
+    }
+  }
+  if((rx_queue.num > 0) && !req_is_pending && !pb_proto_is_peek_pending()) {
+    trigger_request();
+  }
+}
+#endif
+
+// incoming packet via PIO available?
+static u08 task_pio(void)
+{
+  u08 n = pio_has_recv();
+  pio_pending = n;
+#if PKT_BUF_NUM > 1
+  if((n == 0) && (rx_queue.num == 0)) {
+    return 0;
+  }
+#else
+  if(n == 0) {
+    return 0;
+  }
+#endif
+
+  // show first incoming packet
+  if(first && (n > 0)) {
+    first = 0;
+    uart_send_time_stamp_spc();
+    uart_send_pstring(PSTR("FIRST INCOMING!\r\n"));
+  }
+
+  // if we are online then request the packet receiption
+  if(flags & FLAG_ONLINE) {
+#if PKT_BUF_NUM > 1
+    fetch_pkts(n);
+#else
+    // if no request is pending then request it
+    // (but not before the Amiga decided on a peeked packet)
+    if(!pb_proto_is_peek_pending()) {
+      // ARP for the Amiga and unwanted broadcasts are handled here
+      u08 done = 0;
+      // without a request or a peek the frame buffer is idle
+      if(!req_is_pending && (param.proxy_arp || param.bcast_filter)) {
+        done = filter_pkt(pkt_buf_get(work_slot));
+      }
+      if(!done) {
+        trigger_request();
+      }
+    }
+#endif
+  }
+  // offline: get and drop pio packet
+  else {
+    u16 size;
+    pio_util_recv(pkt_buf_get(work_slot), &size);
+    if(global_trace) {
+      trace_event(TRACE_EV_PIO_DROP, size, 0, 0);
+    }
+    uart_send_time_stamp_spc();
+    uart_send_pstring(PSTR("OFFLINE DROP: "));
+    uart_send_hex_word(size);
+    uart_send_crlf();
+  }
+  return 1;
+}
+
+#if PKT_BUF_NUM > 1
+// pass waiting frames of the Amiga to the device
+static u08 task_tx(void)
+{
+  if((tx_queue.num == 0) || tx_busy()) {
+    return 0;
+  }
+  u16 size;
+  u08 slot = pkt_queue_get(&tx_queue, &size);
+  pio_util_send(pkt_buf_get(slot), size);
+  pkt_buf_free(slot);
+  return 1;
+}
+#endif
+
+// flow control. reading the fill level is costly so do not poll every pass
+static u08 task_flow(void)
+{
+  if(flow_control) {
+    flow_update(pio_pending);
+  }
+  return 0;
+}
+
+// serial console
+static u08 task_cmd(void)
+{
+  cmd_result = cmd_worker();
+  return cmd_result != CMD_WORKER_IDLE;
+}
+
+static u08 task_stats(void)
+{
+  return stats_worker();
+}
+
+static const char task_pb_name[] PROGMEM = "pb";
+static const char task_pio_name[] PROGMEM = "pio";
+#if PKT_BUF_NUM > 1
+static const char task_tx_name[] PROGMEM = "tx";
+#endif
+static const char task_flow_name[] PROGMEM = "flow";
+static const char task_cmd_name[] PROGMEM = "cmd";
+static const char task_stats_name[] PROGMEM = "stats";
+
+// in order of priority. periods in 100us
+static const sched_task_t tasks[] PROGMEM = {
+  { task_pb, task_pb_name, 0, 0 },
+  { task_pio, task_pio_name, 0, 0 },
+#if PKT_BUF_NUM > 1
+  { task_tx, task_tx_name, 0, 0 },
+#endif
+  { task_flow, task_flow_name, 5, 0 },
+  { task_cmd, task_cmd_name, 100, SCHED_FLAG_DEFER },
+  { task_stats, task_stats_name, 1000, SCHED_FLAG_DEFER }
+};
+#define NUM_TASKS   (sizeof(tasks) / sizeof(sched_task_t))
+
+static sched_stat_t task_stat[NUM_TASKS];
+
 // ---------- loop ----------
 
 u08 bridge_loop(void)
 {
-  u08 result = CMD_WORKER_IDLE;
-
   uart_send_time_stamp_spc();
   uart_send_pstring(PSTR("[BRIDGE] on\r\n"));
 
-  pb_proto_init(fill_pkt, proc_pkt, pkt_buf, PKT_BUF_SIZE);
+  work_slot = 0;
+#if PKT_BUF_NUM > 1
+  ring_init();
+#endif
+  pb_proto_init(fill_pkt, proc_pkt, pkt_buf_get(work_slot), PKT_BUF_SIZE);
   pio_init(param.mac_addr, pio_util_get_init_flags());
+  pio_util_apply_param();
   stats_reset();
 
   // online flag
   flags = 0;
   req_is_pending = 0;
+  amiga_ip_valid = 0;
+
+  flow_control = param.flow_ctl;
+  flow_paused = 0;
+  pio_pending = 0;
+  first = 1;
+  cmd_result = CMD_WORKER_IDLE;
 
-  u08 flow_control = param.flow_ctl;
-  u08 limit_flow = 0;
-  u08 first = 1;
+  // diagnostics must not stall the data path: drop them if the uart is busy
+  uart_set_tx_drop(1);
+  sched_init(tasks, task_stat, NUM_TASKS);
   while(run_mode == RUN_MODE_BRIDGE) {
-    // handle commands
-    result = cmd_worker();
-    if(result & CMD_WORKER_RESET) {
+    u08 busy = sched_run();
+    if(cmd_result & CMD_WORKER_RESET) {
       break;
     }
 
-    // handle pbproto
-    pb_util_handle();
-
-    // incoming packet via PIO available?
-    u08 n = pio_has_recv();
-    if(n>0) {
-      // show first incoming packet
-      if(first) {
-        first = 0;
-        uart_send_time_stamp_spc();
-        uart_send_pstring(PSTR("FIRST INCOMING!\r\n"));
-      }
-
-      // if we are online then request the packet receiption
-      if(flags & FLAG_ONLINE) {
-        // if no request is pending then request it
-        trigger_request();
-      }  
-      // offline: get and drop pio packet
-      else {
-        u16 size;
-        pio_util_recv_packet(&size);
-        uart_send_time_stamp_spc();
-        uart_send_pstring(PSTR("OFFLINE DROP: "));
-        uart_send_hex_word(size);
-        uart_send_crlf();
-      }
-    }
-
-    // flow control
-    if(flow_control) {
-      // flow limited
-      if(limit_flow) {
-        // disable again?
-        if(n==0) {
-          pio_control(PIO_CONTROL_FLOW, 0);
-          limit_flow = 0;
-          if(global_verbose) {
-            uart_send_time_stamp_spc();
-            uart_send_pstring(PSTR("FLOW off\r\n"));
-          }
-        }
-      } 
-      // no flow limit
-      else {
-        // enable?
-        if(n>1) {
-          pio_control(PIO_CONTROL_FLOW, 1);
-          limit_flow = 1;
-          if(global_verbose) {
-            uart_send_time_stamp_spc();
-            uart_send_pstring(PSTR("FLOW on\r\n"));
-          }
-        }
-      }
-    }
+    // load of the loop for the statistics
+    stats_loop(busy);
   }
 
+  if(flow_paused) {
+    flow_set(0);
+  }
+#if PKT_BUF_NUM > 1
+  flush_tx();
+#endif
+  uart_set_tx_drop(0);
   stats_dump_all();
+  sched_dump();
+  sched_exit();
   pio_exit();
 
   uart_send_time_stamp_spc();
   uart_send_pstring(PSTR("[BRIDGE] off\r\n"));
 
-  return result;
+  return cmd_result;
 }
@@ -30,6 +30,7 @@
 #include "pio_util.h"
 #include "param.h"
 #include "uartutil.h"
+#include "uart.h"
 #include "main.h"
 #include "stats.h"
 #include "cmd.h"
@@ -104,8 +105,10 @@ u08 bridge_test_loop(void)
 
   pb_proto_init(fill_pkt, proc_pkt, pkt_buf, PKT_BUF_SIZE);
   pio_init(param.mac_addr, pio_util_get_init_flags());
+  pio_util_apply_param();
   stats_reset();
   
+  uart_set_tx_drop(1);
   while(run_mode == RUN_MODE_BRIDGE_TEST) {
     // handle commands
     result = cmd_worker();
@@ -139,6 +142,7 @@ u08 bridge_test_loop(void)
     }
   }
 
+  uart_set_tx_drop(0);
   stats_dump_all();
   pio_exit();
 
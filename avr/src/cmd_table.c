@@ -31,6 +31,9 @@
 #include "net/net.h"
 #include "param.h"
 #include "stats.h"
+#include "sched.h"
+#include "pb_util.h"
+#include "pio_util.h"
 
 COMMAND(cmd_quit)
 {
@@ -80,6 +83,14 @@ COMMAND(cmd_param_reset)
   return CMD_OK;
 }
 
+COMMAND(cmd_param_apply)
+{
+  // values that are read on use (e.g. flow thresholds) are already active
+  pb_util_apply_param();
+  pio_util_apply_param();
+  return CMD_OK;
+}
+
 COMMAND(cmd_param_toggle)
 {
   u08 group = argv[0][0];
@@ -97,6 +108,8 @@ COMMAND(cmd_param_toggle)
     switch(type) {
       case 'd': val = &param.full_duplex; result = CMD_OK_RESTART; break;
       case 'c': val = &param.flow_ctl; result = CMD_OK_RESTART; break;
+      case 'a': val = &param.proxy_arp; break;
+      case 'b': val = &param.bcast_filter; break;
       default: return CMD_PARSE_ERROR;
     }
   }
@@ -118,6 +131,42 @@ COMMAND(cmd_param_toggle)
   return result;
 }
 
+COMMAND(cmd_param_byte)
+{
+  u08 group = argv[0][0];
+  u08 type = argv[0][1];
+  u08 *val = 0;
+
+  if(group == 'b') {
+    switch(type) {
+      case 'd': val = &param.pb_burst_delay; break;
+      default: return CMD_PARSE_ERROR;
+    }
+  }
+  else if(group == 'e') {
+    switch(type) {
+      case 'g': val = &param.eth_bbipg; break;
+      case 'i': val = &param.eth_ipg; break;
+      default: return CMD_PARSE_ERROR;
+    }
+  }
+  else {
+    return CMD_PARSE_ERROR;
+  }
+
+  if(argc == 1) {
+    return CMD_PARSE_ERROR;
+  } else {
+    u08 new_val;
+    if(parse_byte(argv[1],&new_val)) {
+      *val = new_val;
+    } else {
+      return CMD_PARSE_ERROR;
+    }
+  }
+  return CMD_OK;
+}
+
 COMMAND(cmd_param_word)
 {
   u08 group = argv[0][0];
@@ -129,6 +178,29 @@ COMMAND(cmd_param_word)
       case 'l': val = &param.test_plen; break;
       case 't': val = &param.test_ptype; break;
       case 'p': val = &param.test_port; break;
+#ifdef DIAG
+      case 'b': val = &param.test_sweep_begin; break;
+      case 'e': val = &param.test_sweep_end; break;
+      case 's': val = &param.test_sweep_step; break;
+      case 'c': val = &param.test_count; break;
+      case 'w': val = &param.test_interval; break;
+#endif
+      default: return CMD_PARSE_ERROR;
+    }
+  }
+  else if(group == 'f') {
+    switch(type) {
+      case 'm': val = &param.mss_clamp; break;
+      case 'p': val = &param.flow_pause; break;
+      case 'r': val = &param.flow_resume; break;
+      case '1': val = &param.bcast_port[0]; break;
+      case '2': val = &param.bcast_port[1]; break;
+      default: return CMD_PARSE_ERROR;
+    }
+  }
+  else if(group == 'b') {
+    switch(type) {
+      case 't': val = &param.pb_timeout; break;
       default: return CMD_PARSE_ERROR;
     }
   }
@@ -176,12 +248,20 @@ COMMAND(cmd_param_ip_addr)
 COMMAND(cmd_stats_dump)
 {
   stats_dump_all();
+  sched_dump();
+  return CMD_OK;
+}
+
+COMMAND(cmd_stats_record)
+{
+  stats_dump_record();
   return CMD_OK;
 }
 
 COMMAND(cmd_stats_reset)
 {
   stats_reset();
+  sched_reset();
   return CMD_OK;
 }
 
@@ -194,19 +274,40 @@ CMD_NAME("p", cmd_param_dump, "print parameters");
 CMD_NAME("ps", cmd_param_save, "save parameters to EEPROM");
 CMD_NAME("pl", cmd_param_load, "load parameters from EEPROM" );
 CMD_NAME("pr", cmd_param_reset, "reset parameters to default" );
+CMD_NAME("pa", cmd_param_apply, "apply timing parameters now" );
   // stats
 CMD_NAME("sd", cmd_stats_dump, "dump statistics" );
 CMD_NAME("sr", cmd_stats_reset, "reset statistics" );
+CMD_NAME("sc", cmd_stats_record, "dump statistics as CSV record" );
   // options
 CMD_NAME("m", cmd_gen_m, "mac address of device <mac>" );
 CMD_NAME("fd", cmd_gen_fd, "set full duple mode [on]" );
 CMD_NAME("fc", cmd_gen_fc, "set flow control [on]" );
+CMD_NAME("fp", cmd_gen_fp, "pause below <n> bytes free rx buffer" );
+CMD_NAME("fr", cmd_gen_fr, "resume above <n> bytes free rx buffer" );
+CMD_NAME("fa", cmd_gen_fa, "answer ARP for the Amiga [on]" );
+CMD_NAME("fm", cmd_gen_fm, "clamp TCP MSS to <n> (0=off)" );
+CMD_NAME("fb", cmd_gen_fb, "drop broadcasts not for the Amiga [on]" );
+CMD_NAME("f1", cmd_gen_f1, "pass UDP broadcasts to port <n>" );
+CMD_NAME("f2", cmd_gen_f2, "pass UDP broadcasts to port <n>" );
+  // timing
+CMD_NAME("bt", cmd_gen_bt, "plipbox handshake timeout in 100us <n>" );
+CMD_NAME("bd", cmd_gen_bd, "burst delay loops per byte <n> (0=default)" );
+CMD_NAME("eg", cmd_gen_eg, "eth back-to-back packet gap <n> (0=default)" );
+CMD_NAME("ei", cmd_gen_ei, "eth packet gap <n> (0=default)" );
   // test
 CMD_NAME("tl", cmd_gen_tl,  "test packet length <n>");
 CMD_NAME("tt", cmd_gen_tt, "test packet eth type <n>" );
 CMD_NAME("ti", cmd_gen_ti, "test IP address <ip>" );
 CMD_NAME("tp", cmd_gen_tp, "test UDP port <n>" );
 CMD_NAME("tm", cmd_gen_tm, "test mode [0|1]" );
+#ifdef DIAG
+CMD_NAME("tb", cmd_gen_tb, "sweep begin packet length <n>" );
+CMD_NAME("te", cmd_gen_te, "sweep end packet length <n>" );
+CMD_NAME("ts", cmd_gen_ts, "sweep packet length step <n>" );
+CMD_NAME("tc", cmd_gen_tc, "sweep/loop test packet count <n>" );
+CMD_NAME("tw", cmd_gen_tw, "loop test interval in ms <n>" );
+#endif
 
 // ----- Entries -----
 const cmd_table_t PROGMEM cmd_table[] = {
@@ -218,18 +319,39 @@ const cmd_table_t PROGMEM cmd_table[] = {
   CMD_ENTRY(cmd_param_save),
   CMD_ENTRY(cmd_param_load),
   CMD_ENTRY(cmd_param_reset),
+  CMD_ENTRY(cmd_param_apply),
   // stats
   CMD_ENTRY(cmd_stats_dump),
   CMD_ENTRY(cmd_stats_reset),
+  CMD_ENTRY(cmd_stats_record),
   // options
   CMD_ENTRY_NAME(cmd_param_mac_addr, cmd_gen_m),
   CMD_ENTRY_NAME(cmd_param_toggle, cmd_gen_fd),
   CMD_ENTRY_NAME(cmd_param_toggle, cmd_gen_fc),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_fp),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_fr),
+  CMD_ENTRY_NAME(cmd_param_toggle, cmd_gen_fa),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_fm),
+  CMD_ENTRY_NAME(cmd_param_toggle, cmd_gen_fb),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_f1),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_f2),
+  // timing
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_bt),
+  CMD_ENTRY_NAME(cmd_param_byte, cmd_gen_bd),
+  CMD_ENTRY_NAME(cmd_param_byte, cmd_gen_eg),
+  CMD_ENTRY_NAME(cmd_param_byte, cmd_gen_ei),
   // test
   CMD_ENTRY_NAME(cmd_param_word, cmd_gen_tl),
   CMD_ENTRY_NAME(cmd_param_word, cmd_gen_tt),
   CMD_ENTRY_NAME(cmd_param_ip_addr, cmd_gen_ti),
   CMD_ENTRY_NAME(cmd_param_word, cmd_gen_tp),
   CMD_ENTRY_NAME(cmd_param_toggle, cmd_gen_tm),
+#ifdef DIAG
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_tb),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_te),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_ts),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_tc),
+  CMD_ENTRY_NAME(cmd_param_word, cmd_gen_tw),
+#endif
   { 0,0 } // last entry
 };
@@ -27,18 +27,26 @@
 #include "cmdkey_table.h"
 
 #include "stats.h"
+#include "sched.h"
 #include "pb_test.h"
+#include "loop_test.h"
 #include "main.h"
 #include "uartutil.h"
+#include "trace.h"
 
 COMMAND_KEY(cmd_dump_stats)
 {
   stats_dump_all();
+  sched_dump();
+#ifdef DEBUG
+  uart_send_free_stack();
+#endif
 }
 
 COMMAND_KEY(cmd_reset_stats)
 {
   stats_reset();
+  sched_reset();
 }
 
 COMMAND_KEY(cmd_enter_pb_test_mode)
@@ -51,6 +59,11 @@ COMMAND_KEY(cmd_enter_pio_test_mode)
   run_mode = RUN_MODE_PIO_TEST;
 }
 
+COMMAND_KEY(cmd_enter_loop_test_mode)
+{
+  run_mode = RUN_MODE_LOOP_TEST;
+}
+
 COMMAND_KEY(cmd_enter_bridge_mode)
 {
   run_mode = RUN_MODE_BRIDGE;
@@ -76,6 +89,16 @@ COMMAND_KEY(cmd_toggle_auto_mode)
   pb_test_toggle_auto();
 }
 
+COMMAND_KEY(cmd_toggle_sweep_mode)
+{
+  pb_test_toggle_sweep();
+}
+
+COMMAND_KEY(cmd_toggle_loop_run)
+{
+  loop_test_toggle_run();
+}
+
 COMMAND_KEY(cmd_toggle_verbose)
 {
   global_verbose = !global_verbose;
@@ -83,27 +106,47 @@ COMMAND_KEY(cmd_toggle_verbose)
   uart_send_pstring(global_verbose ? PSTR("ON\r\n") : PSTR("OFF\r\n"));
 }
 
+COMMAND_KEY(cmd_dump_stats_record)
+{
+  stats_dump_record();
+}
+
+COMMAND_KEY(cmd_toggle_trace)
+{
+  trace_toggle();
+}
+
 CMDKEY_HELP(cmd_enter_bridge_mode, "enter bridge mode");
 CMDKEY_HELP(cmd_enter_bridge_test_mode, "enter bridge test mode");
 CMDKEY_HELP(cmd_enter_pio_test_mode, "enter PIO test mode");
 CMDKEY_HELP(cmd_enter_pb_test_mode, "enter PB test mode");
+CMDKEY_HELP(cmd_enter_loop_test_mode, "enter loop test mode");
 CMDKEY_HELP(cmd_dump_stats, "dump statistics");
 CMDKEY_HELP(cmd_reset_stats, "reset statistics");
+CMDKEY_HELP(cmd_dump_stats_record, "dump statistics as CSV record");
 CMDKEY_HELP(cmd_toggle_verbose, "toggle verbose output");
+CMDKEY_HELP(cmd_toggle_trace, "toggle binary trace output");
 CMDKEY_HELP(cmd_send_test_packet, "send a test packet (pbtest mode)");
 CMDKEY_HELP(cmd_send_test_packet_silent, "send a test packet (silent) (pbtest mode)");
 CMDKEY_HELP(cmd_toggle_auto_mode, "toggle auto send (pbtest mode)");
+CMDKEY_HELP(cmd_toggle_sweep_mode, "toggle packet size sweep (pbtest mode)");
+CMDKEY_HELP(cmd_toggle_loop_run, "start/stop round trip run (loop test mode)");
 
 const cmdkey_table_t PROGMEM cmdkey_table[] = {
   CMDKEY_ENTRY('1', cmd_enter_bridge_mode),
   CMDKEY_ENTRY('2', cmd_enter_bridge_test_mode),
   CMDKEY_ENTRY('3', cmd_enter_pio_test_mode), 
   CMDKEY_ENTRY('4', cmd_enter_pb_test_mode),
+  CMDKEY_ENTRY('5', cmd_enter_loop_test_mode),
   CMDKEY_ENTRY('s', cmd_dump_stats),
   CMDKEY_ENTRY('S', cmd_reset_stats),
+  CMDKEY_ENTRY('x', cmd_dump_stats_record),
   CMDKEY_ENTRY('v', cmd_toggle_verbose),
+  CMDKEY_ENTRY('t', cmd_toggle_trace),
   CMDKEY_ENTRY('p', cmd_send_test_packet),
   CMDKEY_ENTRY('P', cmd_send_test_packet_silent),
   CMDKEY_ENTRY('a', cmd_toggle_auto_mode),
+  CMDKEY_ENTRY('w', cmd_toggle_sweep_mode),
+  CMDKEY_ENTRY('l', cmd_toggle_loop_run),
   { 0,0 }
 };
@@ -214,6 +214,8 @@ void dump_pb_cmd(const pb_proto_stat_t *ps)
       break;
     case PBPROTO_CMD_RECV:
     case PBPROTO_CMD_RECV_BURST:
+    case PBPROTO_CMD_RECV_PEEK:
+    case PBPROTO_CMD_RECV_SKIP:
       break;
     default:
       is_valid = 0;
@@ -39,7 +39,7 @@
 #define ERXST           (0x08|0x00)
 #define ERXND           (0x0A|0x00)
 #define ERXRDPT         (0x0C|0x00)
-// #define ERXWRPT         (0x0E|0x00)
+#define ERXWRPT         (0x0E|0x00)
 #define EDMAST          (0x10|0x00)
 #define EDMAND          (0x12|0x00)
 // #define EDMADST         (0x14|0x00)
@@ -250,6 +250,7 @@ static u08 Enc28j60Bank;
 static u16 gNextPacketPtr;
 static u08 is_full_duplex;
 static u08 rev;
+static u08 rx_filter;
 
 static uint8_t readOp (uint8_t op, uint8_t address) {
     spi_enable_eth();
@@ -290,11 +291,9 @@ static uint8_t readRegByte (uint8_t address) {
     return readOp(ENC28J60_READ_CTRL_REG, address);
 }
 
-#if 0
 static uint16_t readReg(uint8_t address) {
 	return readRegByte(address) + (readRegByte(address+1) << 8);
 }
-#endif
 
 static void writeRegByte (uint8_t address, uint8_t data) {
     SetBank(address);
@@ -328,12 +327,32 @@ static void writePhy (uint8_t address, uint16_t data) {
 // With the bit set, broadcast packets are filtered.
 static inline void enc28j60_enable_broadcast ( void ) 
 {
-  writeRegByte(ERXFCON, ERXFCON_UCEN|ERXFCON_CRCEN/*|ERXFCON_PMEN*/|ERXFCON_BCEN);
+  rx_filter = ERXFCON_UCEN|ERXFCON_CRCEN/*|ERXFCON_PMEN*/|ERXFCON_BCEN;
+  writeRegByte(ERXFCON, rx_filter);
 }
 
 static inline void enc28j60_disable_broadcast ( void ) 
 {
-  writeRegByte(ERXFCON, ERXFCON_UCEN|ERXFCON_CRCEN/*|ERXFCON_PMEN*/);
+  rx_filter = ERXFCON_UCEN|ERXFCON_CRCEN/*|ERXFCON_PMEN*/;
+  writeRegByte(ERXFCON, rx_filter);
+}
+
+// inter packet gaps. 0 selects the value recommended by the data sheet
+static void set_bbipg(u08 gap)
+{
+  if(gap == 0) {
+    gap = is_full_duplex ? 0x15 : 0x12;
+  }
+  writeRegByte(MABBIPG, gap);
+}
+
+static void set_ipg(u08 gap)
+{
+  if(gap == 0) {
+    gap = 0x12;
+  }
+  // MAIPGH is only used in half duplex
+  writeReg(MAIPG, is_full_duplex ? gap : (0x0C00 | gap));
 }
 
 static u08 enc28j60_init(const u08 macaddr[6], u08 flags)
@@ -384,13 +403,8 @@ static u08 enc28j60_init(const u08 macaddr[6], u08 flags)
   }
   writeRegByte(MACON3, mac3val);
   
-  if(is_full_duplex) {
-    writeRegByte(MABBIPG, 0x15);      
-    writeReg(MAIPG, 0x0012);
-  } else {
-    writeRegByte(MABBIPG, 0x12);
-    writeReg(MAIPG, 0x0C12);
-  }
+  set_bbipg(0);
+  set_ipg(0);
   writeReg(MAMXFL, MAX_FRAMELEN);
 
   // PHY init
@@ -452,11 +466,64 @@ static u08 enc28j60_control(u08 control_id, u08 value)
         writeRegByte(EFLOCON, flag);
         return PIO_OK;
       }
+    case PIO_CONTROL_BBIPG:
+      set_bbipg(value);
+      return PIO_OK;
+    case PIO_CONTROL_IPG:
+      set_ipg(value);
+      return PIO_OK;
     default:
       return PIO_NOT_FOUND;
   }
 }
 
+// ---------- multicast ----------
+
+// hash table index of a MAC: bits 28..23 of the ethernet CRC
+static u08 mcast_hash(const u08 *mac)
+{
+  u32 crc = 0xffffffff;
+  for(u08 i=0;i<6;i++) {
+    u08 b = mac[i];
+    for(u08 j=0;j<8;j++) {
+      u08 bit = ((u08)(crc >> 31) ^ b) & 1;
+      crc <<= 1;
+      if(bit) {
+        crc ^= 0x04c11db7;
+      }
+      b >>= 1;
+    }
+  }
+  return (u08)(crc >> 23) & 0x3f;
+}
+
+static u08 enc28j60_mcast(const u08 *mac_list, u08 num)
+{
+  u08 table[8];
+  u08 fill = (num == PIO_MCAST_ALL) ? 0xff : 0;
+  for(u08 i=0;i<8;i++) {
+    table[i] = fill;
+  }
+  if(num != PIO_MCAST_ALL) {
+    for(u08 i=0;i<num;i++) {
+      u08 idx = mcast_hash(mac_list);
+      table[idx >> 3] |= 1 << (idx & 7);
+      mac_list += 6;
+    }
+  }
+
+  // program hash table and enable it in the receive filter
+  for(u08 i=0;i<8;i++) {
+    writeRegByte(EHT0 + i, table[i]);
+  }
+  u08 filter = rx_filter;
+  if(num > 0) {
+    filter |= ERXFCON_HTEN;
+  }
+  writeRegByte(ERXFCON, filter);
+  return PIO_OK;
+}
+
 // ---------- status ----------
 
 static u08 enc28j60_status(u08 status_id, u08 *value)
@@ -468,6 +535,26 @@ static u08 enc28j60_status(u08 status_id, u08 *value)
     case PIO_STATUS_LINK_UP:
       *value = (readPhyByte(PHSTAT2) >> 2) & 1;
       return PIO_OK;
+    case PIO_STATUS_RX_FREE:
+      {
+        // free space between write and read pointer of the rx ring
+        u16 wr = readReg(ERXWRPT);
+        u16 rd = readReg(ERXRDPT);
+        u16 free;
+        if(wr > rd) {
+          free = (RXSTOP_INIT - RXSTART_INIT) - (wr - rd);
+        } else if(wr == rd) {
+          free = RXSTOP_INIT - RXSTART_INIT;
+        } else {
+          free = rd - wr - 1;
+        }
+        free >>= PIO_RX_FREE_SHIFT;
+        *value = (free > 0xff) ? 0xff : (u08)free;
+        return PIO_OK;
+      }
+    case PIO_STATUS_TX_BUSY:
+      *value = (readOp(ENC28J60_READ_CTRL_REG, ECON1) & ECON1_TXRTS) ? 1 : 0;
+      return PIO_OK;
     default:
       *value = 0;
       return PIO_NOT_FOUND;
@@ -492,6 +579,13 @@ static u08 enc28j60_get_status( void )
 
 static u08 enc28j60_send(const u08 *data, u16 size)
 {
+  // wait for tx ready: the buffer still holds the frame on the wire
+  while (readOp(ENC28J60_READ_CTRL_REG, ECON1) & ECON1_TXRTS)
+      if (readRegByte(EIR) & EIR_TXERIF) {
+          writeOp(ENC28J60_BIT_FIELD_SET, ECON1, ECON1_TXRST);
+          writeOp(ENC28J60_BIT_FIELD_CLR, ECON1, ECON1_TXRST);
+      }
+
   // prepare tx buffer write
   writeReg(EWRPT, TXSTART_INIT);
   writeOp(ENC28J60_WRITE_BUF_MEM, 0, 0x00);
@@ -505,13 +599,6 @@ static u08 enc28j60_send(const u08 *data, u16 size)
   }
   spi_disable_eth();
 
-  // wait for tx ready
-  while (readOp(ENC28J60_READ_CTRL_REG, ECON1) & ECON1_TXRTS)
-      if (readRegByte(EIR) & EIR_TXERIF) {
-          writeOp(ENC28J60_BIT_FIELD_SET, ECON1, ECON1_TXRST);
-          writeOp(ENC28J60_BIT_FIELD_CLR, ECON1, ECON1_TXRST);
-      }
-
   // initiate send
   writeReg(ETXND, TXSTART_INIT+size);
   writeOp(ENC28J60_BIT_FIELD_SET, ECON1, ECON1_TXRTS);
@@ -572,6 +659,28 @@ static u08 enc28j60_recv(u08 *data, u16 max_size, u16 *got_size)
   return result;
 }
 
+// ---------- peek ----------
+
+static u08 enc28j60_peek(u08 *data, u16 max_size, u16 *got_size)
+{
+  // read header without moving on to the next packet
+  u16 next = gNextPacketPtr;
+  writeReg(ERDPT, next);
+  u08 status = read_hdr(got_size);
+  gNextPacketPtr = next;
+
+  if ((status & 0x80)==0) {
+    return PIO_IO_ERR;
+  }
+
+  u16 len = *got_size;
+  if(len > max_size) {
+    len = max_size;
+  }
+  readBuf(len, data);
+  return PIO_OK;
+}
+
 // ---------- has_recv ----------
 
 static u08 enc28j60_has_recv(void)
@@ -684,7 +793,9 @@ const pio_dev_t PROGMEM pio_dev_enc28j60 = {
   .exit_f = enc28j60_exit,
   .send_f = enc28j60_send,
   .recv_f = enc28j60_recv,
+  .peek_f = enc28j60_peek,
   .has_recv_f = enc28j60_has_recv,
   .status_f = enc28j60_status,
-  .control_f = enc28j60_control
+  .control_f = enc28j60_control,
+  .mcast_f = enc28j60_mcast
 };
@@ -31,8 +31,14 @@ typedef unsigned char  u08;
 typedef   signed char  s08;
 typedef unsigned short u16;
 typedef   signed short s16;
+#ifdef HAVE_host
+// keep 32 bit types on 64 bit hosts
+typedef unsigned int   u32;
+typedef   signed int   s32;
+#else
 typedef unsigned long  u32;
 typedef   signed long  s32;
+#endif
 typedef unsigned long long u64;
 typedef   signed long long s64;
 
@@ -0,0 +1,50 @@
+/*
+ * eeprom.h - host build replacement for avr-libc <avr/eeprom.h>
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+// EEMEM variables are plain RAM: parameters do not survive a restart
+#define EEMEM
+
+static __inline__ uint8_t eeprom_is_ready(void) { return 1; }
+
+static __inline__ void eeprom_read_block(void *dst, const void *src, size_t n)
+{ memcpy(dst, src, n); }
+
+static __inline__ void eeprom_write_block(const void *src, void *dst, size_t n)
+{ memcpy(dst, src, n); }
+
+static __inline__ uint16_t eeprom_read_word(const uint16_t *addr)
+{ return *addr; }
+
+static __inline__ void eeprom_write_word(uint16_t *addr, uint16_t value)
+{ *addr = value; }
+
+#endif
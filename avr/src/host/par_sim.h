@@ -0,0 +1,60 @@
+/*
+ * par_sim.h - shared memory parallel port of the host build
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef PAR_SIM_H
+#define PAR_SIM_H
+
+#include "global.h"
+
+// name of the POSIX shared memory object (override with $PLIPBOX_SHM)
+#define PAR_SIM_SHM_NAME    "/plipbox_par"
+
+/*
+    Simulated Parallel Port
+
+    Each line uses bit 0 of its own byte. The Amiga side (an emulator
+    or a test client) maps the same object and drives the first four
+    bytes, the plipbox drives the rest.
+*/
+typedef struct {
+  // driven by the Amiga
+  volatile u08 data_in;     // D0-D7 if the Amiga drives the bus
+  volatile u08 strobe;      // /STROBE
+  volatile u08 select;      // SELECT
+  volatile u08 pout;        // POUT (REQ)
+  // driven by the plipbox
+  volatile u08 data_out;    // D0-D7 if the plipbox drives the bus
+  volatile u08 data_ddr;    // 0xff: plipbox drives the bus
+  volatile u08 busy;        // BUSY (RAK)
+  volatile u08 ack;         // /ACK
+  volatile u32 ack_pulses;  // count of /ACK pulses (FLG edge latch)
+} par_sim_t;
+
+extern par_sim_t *par_sim;
+// dummy register for pull-up and direction writes of the signal lines
+extern u08 par_sim_dummy;
+
+#endif
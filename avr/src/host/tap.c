@@ -0,0 +1,238 @@
+/*
+ * tap.c - Linux TAP packet I/O device of the host build
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+
+#include "tap.h"
+#include "pio.h"
+#include "net/net.h"
+
+#define TAP_MAX_FRAME   1518
+
+static int tap_fd = -1;
+static u08 tap_mac[6];
+static u08 tap_flags;
+static u08 mcast_num;
+static u08 mcast_list[PIO_MCAST_MAX * 6];
+
+// a frame read ahead by has_recv() that passed the filter
+static u08 rx_buf[TAP_MAX_FRAME];
+static u16 rx_size;
+
+// ---------- init ----------
+
+static u08 tap_init(const u08 mac[6], u08 flags)
+{
+  const char *name = getenv("PLIPBOX_TAP");
+  if(name == NULL) {
+    name = TAP_DEFAULT_NAME;
+  }
+
+  tap_fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+  if(tap_fd < 0) {
+    perror("open /dev/net/tun");
+    return PIO_NOT_FOUND;
+  }
+
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+  strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+  if(ioctl(tap_fd, TUNSETIFF, &ifr) < 0) {
+    perror("TUNSETIFF");
+    close(tap_fd);
+    tap_fd = -1;
+    return PIO_NOT_FOUND;
+  }
+
+  net_copy_mac(mac, tap_mac);
+  tap_flags = flags;
+  mcast_num = 0;
+  rx_size = 0;
+  return PIO_OK;
+}
+
+// ---------- exit ----------
+
+static void tap_exit(void)
+{
+  if(tap_fd >= 0) {
+    close(tap_fd);
+    tap_fd = -1;
+  }
+}
+
+// ---------- control ----------
+
+static u08 tap_control(u08 control_id, u08 value)
+{
+  switch(control_id) {
+    case PIO_CONTROL_FLOW:
+      // the kernel queue does the flow control for us
+      return PIO_OK;
+    default:
+      return PIO_NOT_FOUND;
+  }
+}
+
+// ---------- multicast ----------
+
+static u08 tap_mcast(const u08 *mac_list, u08 num)
+{
+  if(num != PIO_MCAST_ALL) {
+    memcpy(mcast_list, mac_list, num * 6);
+  }
+  mcast_num = num;
+  return PIO_OK;
+}
+
+// ---------- status ----------
+
+static u08 tap_status(u08 status_id, u08 *value)
+{
+  switch(status_id) {
+    case PIO_STATUS_VERSION:
+      *value = 1;
+      return PIO_OK;
+    case PIO_STATUS_LINK_UP:
+      *value = (tap_fd >= 0);
+      return PIO_OK;
+    default:
+      return PIO_NOT_FOUND;
+  }
+}
+
+// ---------- send ----------
+
+static u08 tap_send(const u08 *data, u16 size)
+{
+  if(write(tap_fd, data, size) != size) {
+    return PIO_IO_ERR;
+  }
+  return PIO_OK;
+}
+
+// ---------- recv ----------
+
+// do what the receive filter of the ENC28J60 does
+static u08 accept_frame(const u08 *buf)
+{
+  const u08 *tgt = buf;
+  if(net_compare_mac(tgt, tap_mac)) {
+    return 1;
+  }
+  if(net_compare_bcast_mac(tgt)) {
+    return (tap_flags & PIO_INIT_BROAD_CAST) == PIO_INIT_BROAD_CAST;
+  }
+  if(tgt[0] & 1) {
+    if(mcast_num == PIO_MCAST_ALL) {
+      return 1;
+    }
+    for(u08 i=0;i<mcast_num;i++) {
+      if(net_compare_mac(tgt, mcast_list + i * 6)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static u08 tap_has_recv(void)
+{
+  if(rx_size > 0) {
+    return 1;
+  }
+  // read ahead until a frame passes the filter or the queue is empty
+  while(1) {
+    ssize_t n = read(tap_fd, rx_buf, sizeof(rx_buf));
+    if(n <= 0) {
+      return 0;
+    }
+    if((n >= 14) && accept_frame(rx_buf)) {
+      rx_size = (u16)n;
+      return 1;
+    }
+  }
+}
+
+static u08 tap_recv(u08 *data, u16 max_size, u16 *got_size)
+{
+  if(!tap_has_recv()) {
+    *got_size = 0;
+    return PIO_IO_ERR;
+  }
+
+  u16 len = rx_size;
+  u08 result = PIO_OK;
+  *got_size = len;
+  rx_size = 0;
+  if(len > max_size) {
+    len = max_size;
+    result = PIO_TOO_LARGE;
+  }
+  memcpy(data, rx_buf, len);
+  return result;
+}
+
+static u08 tap_peek(u08 *data, u16 max_size, u16 *got_size)
+{
+  if(!tap_has_recv()) {
+    *got_size = 0;
+    return PIO_IO_ERR;
+  }
+
+  u16 len = rx_size;
+  *got_size = len;
+  if(len > max_size) {
+    len = max_size;
+  }
+  memcpy(data, rx_buf, len);
+  return PIO_OK;
+}
+
+// ----- pio_dev -----
+static const char PROGMEM dev_name[] = "tap";
+const pio_dev_t PROGMEM pio_dev_tap = {
+  .name = dev_name,
+  .init_f = tap_init,
+  .exit_f = tap_exit,
+  .send_f = tap_send,
+  .recv_f = tap_recv,
+  .peek_f = tap_peek,
+  .has_recv_f = tap_has_recv,
+  .status_f = tap_status,
+  .control_f = tap_control,
+  .mcast_f = tap_mcast
+};
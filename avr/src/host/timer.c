@@ -0,0 +1,128 @@
+/*
+ * timer.c - timer emulation of the host build
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include <pthread.h>
+#include <time.h>
+
+#include "global.h"
+#include "timer.h"
+
+// timer counter
+volatile u16 timer_100us = 0;
+volatile u16 timer_10ms = 0;
+volatile u32 time_stamp = 0;
+volatile u16 timer_1s = 0;
+static u16 count;
+static u16 count_1s;
+
+static pthread_t tick_thread;
+static u08 tick_running;
+
+static volatile u16 tcnt1;
+static u16 tcnt1_last;
+
+static u16 clock_4us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (u16)(ts.tv_sec * 250000 + ts.tv_nsec / 4000);
+}
+
+// replaces the timer2 compare ISR: runs every 100us
+static void *tick_func(void *arg)
+{
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while(1) {
+    next.tv_nsec += 100000;
+    if(next.tv_nsec >= 1000000000) {
+      next.tv_nsec -= 1000000000;
+      next.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+    timer_100us++;
+    time_stamp++;
+    count++;
+    if(count == 1000) {
+      count = 0;
+      timer_10ms++;
+    }
+    count_1s++;
+    if(count_1s == 10000) {
+      count_1s = 0;
+      timer_1s++;
+    }
+  }
+  return NULL;
+}
+
+void timer_init(void)
+{
+  timer_100us = 0;
+  timer_10ms = 0;
+  time_stamp = 0;
+  timer_1s = 0;
+  count = 0;
+  count_1s = 0;
+
+  tcnt1 = 0;
+  tcnt1_last = clock_4us();
+
+  if(!tick_running) {
+    pthread_create(&tick_thread, NULL, tick_func, NULL);
+    tick_running = 1;
+  }
+}
+
+// TCNT1 replacement: advance the counter by the 4us ticks since last access
+volatile u16 *timer_host_tcnt1(void)
+{
+  u16 now = clock_4us();
+  tcnt1 += (u16)(now - tcnt1_last);
+  tcnt1_last = now;
+  return &tcnt1;
+}
+
+void timer_delay_10ms(u16 timeout)
+{ timer_10ms=0; while(timer_10ms<timeout); }
+
+void timer_delay_100us(u16 timeout)
+{ timer_100us=0; while(timer_100us<timeout); }
+
+// hw timer
+
+u16 timer_hw_calc_rate_kbs(u16 bytes, u16 delta)
+{
+  if(delta != 0) {
+    u32 nom = 1000 * (u32)bytes * 100;
+    u32 denom = (u32)delta * 4; 
+    u32 rate = nom / denom;
+    return (u16)rate;
+  } else {
+    return 0;
+  }
+}
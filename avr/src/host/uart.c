@@ -0,0 +1,105 @@
+/*
+ * uart.c - console on stdin/stdout for the host build
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "global.h"
+#include "uart.h"
+
+static struct termios old_tio;
+static u08 tio_saved;
+static u08 tx_drop;
+
+static void restore_tty(void)
+{
+  if(tio_saved) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &old_tio);
+  }
+}
+
+void uart_init(void)
+{
+  // single key input without echo like a serial terminal
+  if(!tio_saved && isatty(STDIN_FILENO)) {
+    struct termios tio;
+    tcgetattr(STDIN_FILENO, &old_tio);
+    tio = old_tio;
+    tio.c_lflag &= ~(ICANON | ECHO);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+    tio_saved = 1;
+    atexit(restore_tty);
+  }
+}
+
+u08 uart_read_data_available(void)
+{
+  struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+  return poll(&pfd, 1, 0) > 0;
+}
+
+u08 uart_read(void)
+{
+  u08 data;
+  if(read(STDIN_FILENO, &data, 1) != 1) {
+    // stdin closed: leave the emulator
+    exit(0);
+  }
+  return data;
+}
+
+void uart_send(u08 data)
+{
+  putchar(data);
+  if(data == '\n') {
+    fflush(stdout);
+  }
+}
+
+u08 uart_send_nb(const u08 *data, u08 size)
+{
+  fwrite(data, 1, size, stdout);
+  fflush(stdout);
+  return 1;
+}
+
+// stdout is buffered by libc: nothing is dropped
+u08 uart_set_tx_drop(u08 on)
+{
+  u08 old = tx_drop;
+  tx_drop = on;
+  return old;
+}
+
+u16 uart_get_tx_drops(void)
+{
+  return 0;
+}
@@ -0,0 +1,359 @@
+/*
+ * loop_test.c: plipbox loopback round trip test mode
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "loop_test.h"
+
+#include "uartutil.h"
+#include "uart.h"
+#include "pb_proto.h"
+#include "pb_util.h"
+#include "param.h"
+#include "stats.h"
+#include "main.h"
+#include "cmd.h"
+#include "timer.h"
+#include "util.h"
+#include "net/net.h"
+#include "net/eth.h"
+#include "pkt_buf.h"
+
+#ifdef DIAG
+
+// payload: seq word and time stamp of the request
+#define LOOP_OFF_SEQ    ETH_HDR_SIZE
+#define LOOP_OFF_TS     (ETH_HDR_SIZE + 2)
+#define LOOP_MIN_SIZE   (ETH_HDR_SIZE + 6)
+
+// a frame not returned within 1s (in 100us) is lost
+#define LOOP_TIMEOUT    10000
+
+// histogram buckets: <0.5ms, <1ms, <2ms, ... <32ms, more
+#define LOOP_NUM_BUCKETS  8
+#define LOOP_FIRST_BUCKET 5   // in 100us
+
+static u08 run;
+static u08 waiting;       // a frame is on its way
+static u16 seq;
+static u16 left;          // frames left in this run
+static u32 req_ts;        // time stamp of request of current frame
+static u32 next_ts;       // earliest time stamp of next request
+
+// results
+static u16 num_ok;
+static u16 num_lost;
+static u16 num_err;
+static u16 num_rx_err;    // the echo may still arrive
+static u32 rtt_min;
+static u32 rtt_max;
+static u32 rtt_sum;
+static u32 lat_sum;       // request to recv command of the Amiga
+static u16 lat_cnt;
+static u16 hist[LOOP_NUM_BUCKETS];
+
+static u16 get_size(void)
+{
+  u16 size = param.test_plen;
+  if(size < LOOP_MIN_SIZE) {
+    size = LOOP_MIN_SIZE;
+  }
+  return size;
+}
+
+// ----- Packet Callbacks -----
+
+static u08 fill_pkt(u08 *buf, u16 max_size, u16 *size)
+{
+  *size = get_size();
+  if(*size > max_size) {
+    return PBPROTO_STATUS_PACKET_TOO_LARGE;
+  }
+
+  net_copy_bcast_mac(buf + ETH_OFF_TGT_MAC);
+  net_copy_mac(param.mac_addr, buf + ETH_OFF_SRC_MAC);
+  net_put_word(buf + ETH_OFF_TYPE, ETH_TYPE_MAGIC_LOOPBACK);
+  net_put_word(buf + LOOP_OFF_SEQ, seq);
+  net_put_long(buf + LOOP_OFF_TS, req_ts);
+
+  u08 *ptr = buf + LOOP_MIN_SIZE;
+  u16 num = *size - LOOP_MIN_SIZE;
+  u08 val = (u08)seq;
+  while(num > 0) {
+    *ptr = val;
+    ptr++;
+    val++;
+    num--;
+  }
+
+  return PBPROTO_STATUS_OK;
+}
+
+static void account_rtt(u32 rtt)
+{
+  num_ok++;
+  rtt_sum += rtt;
+  if(rtt < rtt_min) {
+    rtt_min = rtt;
+  }
+  if(rtt > rtt_max) {
+    rtt_max = rtt;
+  }
+
+  u08 b = 0;
+  u32 limit = LOOP_FIRST_BUCKET;
+  while((b < (LOOP_NUM_BUCKETS - 1)) && (rtt >= limit)) {
+    b++;
+    limit <<= 1;
+  }
+  hist[b]++;
+}
+
+static u08 proc_pkt(const u08 *buf, u16 size)
+{
+  u32 now = time_stamp;
+
+  // the online magic or other frames of the driver are no answers
+  if((size < LOOP_MIN_SIZE) ||
+     (eth_get_pkt_type(buf) != ETH_TYPE_MAGIC_LOOPBACK)) {
+    return PBPROTO_STATUS_OK;
+  }
+
+  // late answer of a lost frame
+  if(!waiting || (net_get_word(buf + LOOP_OFF_SEQ) != seq)) {
+    return PBPROTO_STATUS_OK;
+  }
+
+  waiting = 0;
+  if((size != get_size()) || (net_get_long(buf + LOOP_OFF_TS) != req_ts)) {
+    return PBPROTO_STATUS_ERROR;
+  }
+
+  account_rtt(now - req_ts);
+  return PBPROTO_STATUS_OK;
+}
+
+// ----- results -----
+
+static void send_ms(PGM_P str, u32 val)
+{
+  u08 buf[8];
+  uart_send_pstring(str);
+  dword_to_dec(val, buf, 6, 1);
+  uart_send_data(buf, 7);
+  uart_send_spc();
+}
+
+static void dump_result(void)
+{
+  uart_send_pstring(PSTR("ok="));
+  uart_send_hex_word(num_ok);
+  uart_send_pstring(PSTR(" lost="));
+  uart_send_hex_word(num_lost);
+  uart_send_pstring(PSTR(" err="));
+  uart_send_hex_word(num_err);
+  uart_send_pstring(PSTR(" rxerr="));
+  uart_send_hex_word(num_rx_err);
+  uart_send_pstring(PSTR(" size="));
+  uart_send_hex_word(get_size());
+  uart_send_crlf();
+
+  if(num_ok == 0) {
+    return;
+  }
+
+  // all times in ms
+  send_ms(PSTR("rtt min="), rtt_min);
+  send_ms(PSTR("avg="), rtt_sum / num_ok);
+  send_ms(PSTR("max="), rtt_max);
+  send_ms(PSTR("req avg="), lat_cnt ? lat_sum / lat_cnt : 0);
+  uart_send_crlf();
+
+  u32 limit = LOOP_FIRST_BUCKET;
+  for(u08 i=0;i<LOOP_NUM_BUCKETS;i++) {
+    if(i < (LOOP_NUM_BUCKETS - 1)) {
+      send_ms(PSTR("  <"), limit);
+      limit <<= 1;
+    } else {
+      send_ms(PSTR(" >="), limit >> 1);
+    }
+    uart_send_pstring(PSTR(": "));
+    uart_send_hex_word(hist[i]);
+    uart_send_crlf();
+  }
+}
+
+static void reset_result(void)
+{
+  num_ok = 0;
+  num_lost = 0;
+  num_err = 0;
+  num_rx_err = 0;
+  rtt_min = 0xffffffff;
+  rtt_max = 0;
+  rtt_sum = 0;
+  lat_sum = 0;
+  lat_cnt = 0;
+  for(u08 i=0;i<LOOP_NUM_BUCKETS;i++) {
+    hist[i] = 0;
+  }
+}
+
+static void stop_run(void)
+{
+  run = 0;
+  waiting = 0;
+
+  u08 old_drop = uart_set_tx_drop(0);
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[LOOP] off\r\n"));
+  dump_result();
+  uart_set_tx_drop(old_drop);
+}
+
+// ----- worker -----
+
+static void send_next(void)
+{
+  u32 now = time_stamp;
+  if((u32)(now - next_ts) & 0x80000000) {
+    // interval not reached yet
+    return;
+  }
+
+  seq++;
+  req_ts = now;
+  // interval in ms
+  next_ts = now + (u32)param.test_interval * 10;
+  waiting = 1;
+  left--;
+  pb_proto_request_recv();
+}
+
+static void loop_test_worker(void)
+{
+  u08 status = pb_util_handle();
+  const pb_proto_stat_t *ps = &pb_proto_stat;
+
+  if(!run) {
+    return;
+  }
+
+  // transfer failed or the echo was corrupted
+  if((status != PBPROTO_STATUS_OK) && (status != PBPROTO_STATUS_IDLE)) {
+    if(ps->is_send) {
+      num_err++;
+      waiting = 0;
+    } else {
+      num_rx_err++;
+    }
+  }
+
+  if(waiting) {
+    // the Amiga fetched the frame: driver latency of this request
+    if((status == PBPROTO_STATUS_OK) && !ps->is_send &&
+       (ps->cmd != PBPROTO_CMD_RECV_PEEK)) {
+      lat_sum += ps->recv_delta;
+      lat_cnt++;
+    }
+    else if((u32)(time_stamp - req_ts) >= LOOP_TIMEOUT) {
+      num_lost++;
+      waiting = 0;
+    }
+  }
+  else if(left > 0) {
+    send_next();
+  }
+  else {
+    stop_run();
+  }
+}
+
+u08 loop_test_loop(void)
+{
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[LOOP_TEST] on\r\n"));
+
+  stats_reset();
+
+  pb_proto_init(fill_pkt, proc_pkt, pkt_buf, PKT_BUF_SIZE);
+  run = 0;
+  waiting = 0;
+  seq = 0;
+
+  u08 result = CMD_WORKER_IDLE;
+  uart_set_tx_drop(1);
+  while(run_mode == RUN_MODE_LOOP_TEST) {
+    // command line handling
+    result = cmd_worker();
+    if(result & CMD_WORKER_RESET) {
+      break;
+    }
+
+    loop_test_worker();
+  }
+
+  uart_set_tx_drop(0);
+  stats_dump(1,0);
+
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[LOOP_TEST] off\r\n"));
+
+  return result;
+}
+
+void loop_test_toggle_run(void)
+{
+  if(run_mode != RUN_MODE_LOOP_TEST) {
+    return;
+  }
+  if(run) {
+    stop_run();
+    return;
+  }
+
+  reset_result();
+  left = param.test_count;
+  next_ts = time_stamp;
+  run = 1;
+
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[LOOP] on\r\n"));
+}
+
+#else
+
+// the loop test does not fit the 2 KB parts: fall back to the bridge
+u08 loop_test_loop(void)
+{
+  uart_send_pstring(PSTR("[LOOP_TEST] not built in\r\n"));
+  run_mode = RUN_MODE_BRIDGE;
+  return CMD_WORKER_IDLE;
+}
+
+void loop_test_toggle_run(void)
+{
+}
+
+#endif
@@ -34,9 +34,11 @@
 #include "par_low.h"
 #include "param.h"
 #include "cmd.h"
+#include "pb_util.h"
 
 #include "pb_test.h"
 #include "pio_test.h"
+#include "loop_test.h"
 #include "bridge_test.h"
 #include "bridge.h"
 #include "main.h"
@@ -79,6 +81,7 @@ static void loop(void)
   // select main loop depending on current run mode
   while(1) {
     u08 result = CMD_WORKER_IDLE;
+    pb_util_apply_param();
     switch(run_mode) {
       case RUN_MODE_PB_TEST:
         result = pb_test_loop();
@@ -89,6 +92,9 @@ static void loop(void)
       case RUN_MODE_BRIDGE_TEST:
         result = bridge_test_loop();
         break;
+      case RUN_MODE_LOOP_TEST:
+        result = loop_test_loop();
+        break;
       case RUN_MODE_BRIDGE:
       default:
         result = bridge_loop();
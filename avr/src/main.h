@@ -33,6 +33,7 @@
 #define RUN_MODE_BRIDGE_TEST	1
 #define RUN_MODE_PB_TEST 		2
 #define RUN_MODE_PIO_TEST 		3
+#define RUN_MODE_LOOP_TEST 		4
 
 
 /* access run mode for command keys */
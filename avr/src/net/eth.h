@@ -43,6 +43,7 @@
 #define ETH_TYPE_MAGIC_ONLINE	0xffff
 #define ETH_TYPE_MAGIC_OFFLINE  0xfffe
 #define ETH_TYPE_MAGIC_LOOPBACK 0xfffd
+#define ETH_TYPE_MAGIC_MCAST    0xfffc
 
 #define ETH_TYPE_MAGIC_LOOPBACK 0XFFFD
 
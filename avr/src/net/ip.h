@@ -47,5 +47,6 @@ inline const u08 *ip_get_tgt_ip(const u08 *buf) { return buf + 16; }
 inline u16 ip_get_total_length(const u08 *buf) { return (u16)buf[2] << 8 | (u16)buf[3]; }
 inline u08 ip_get_hdr_length(const u08 *buf) { return (buf[0] & 0xf) * 4; }
 inline u08 ip_get_protocol(const u08 *buf) { return buf[9]; }
+inline u16 ip_get_frag_offset(const u08 *buf) { return ((u16)(buf[6] & 0x1f) << 8) | (u16)buf[7]; }
 
 #endif
\ No newline at end of file
@@ -27,6 +27,7 @@
 #include "net.h"
 #include "util.h"
 #include "uartutil.h"
+#include "uart.h"
 
 const u08 net_bcast_mac[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
 const u08 net_zero_mac[6] = { 0,0,0,0,0,0 };
@@ -71,17 +72,14 @@ void net_put_long(u08 *buf, u32 value)
   buf[3] = (u08)(value & 0xff);
 }
 
-static char *mac_str = "00:00:00:00:00:00";
-static char *ip_str = "000.000.000.000";
-
 void net_dump_mac(const u08 *in)
 {
-  int pos = 0;
   for(int i=0;i<6;i++) {
-    byte_to_hex(in[i],(u08 *)(mac_str+pos));
-    pos += 3;
+    if(i > 0) {
+      uart_send(':');
+    }
+    uart_send_hex_byte(in[i]);
   }
-  uart_send_string(mac_str);
 }
 
 u08 net_parse_ip(const u08 *buf, u08 *ip)
@@ -113,12 +111,14 @@ u08 net_parse_mac(const u08 *buf, u08 *mac)
 
 void net_dump_ip(const u08 *in)
 {
-  int pos = 0;
+  u08 buf[3];
   for(int i=0;i<4;i++) {
-    byte_to_dec(in[i],(u08 *)(ip_str+pos));
-    pos += 4;
+    if(i > 0) {
+      uart_send('.');
+    }
+    byte_to_dec(in[i],buf);
+    uart_send_data(buf,3);
   }
-  uart_send_string(ip_str);
 }
 
 u08  net_compare_mac(const u08 *a, const u08 *b)
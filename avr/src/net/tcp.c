@@ -0,0 +1,101 @@
+/*
+ * tcp.c - TCP helpers
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+
+#include "tcp.h"
+#include "net.h"
+
+#define TCP_OPT_END     0
+#define TCP_OPT_NOP     1
+#define TCP_OPT_MSS     2
+#define TCP_OPT_MSS_LEN 4
+
+static u16 swap_word(u16 v)
+{
+  return (v << 8) | (v >> 8);
+}
+
+void tcp_update_checksum(u08 *tcp_buf, u16 old_val, u16 new_val)
+{
+  // RFC 1624: HC' = ~(~HC + ~m + m')
+  u32 sum = (u16)~net_get_word(tcp_buf + TCP_CHECKSUM_OFF);
+  sum += (u16)~old_val;
+  sum += new_val;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  net_put_word(tcp_buf + TCP_CHECKSUM_OFF, ~(u16)sum);
+}
+
+u08 tcp_clamp_mss(u08 *tcp_buf, u16 size, u16 max_mss)
+{
+  if(size < TCP_MIN_HDR_SIZE) {
+    return 0;
+  }
+  if((tcp_get_flags(tcp_buf) & TCP_FLAGS_SYN) == 0) {
+    return 0;
+  }
+  u16 hdr_size = tcp_get_data_ptr(tcp_buf) - tcp_buf;
+  if((hdr_size < TCP_MIN_HDR_SIZE) || (hdr_size > size)) {
+    return 0;
+  }
+
+  // search MSS option
+  u16 off = TCP_MIN_HDR_SIZE;
+  while(off < hdr_size) {
+    u08 kind = tcp_buf[off];
+    if(kind == TCP_OPT_END) {
+      break;
+    }
+    if(kind == TCP_OPT_NOP) {
+      off++;
+      continue;
+    }
+    if((off + 1) >= hdr_size) {
+      break;
+    }
+    u08 len = tcp_buf[off + 1];
+    if((len < 2) || ((off + len) > hdr_size)) {
+      break;
+    }
+    if((kind == TCP_OPT_MSS) && (len == TCP_OPT_MSS_LEN)) {
+      u08 *ptr = tcp_buf + off + 2;
+      u16 mss = net_get_word(ptr);
+      if(mss <= max_mss) {
+        return 0;
+      }
+      net_put_word(ptr, max_mss);
+      // a word on an odd offset is summed with swapped bytes
+      if(off & 1) {
+        tcp_update_checksum(tcp_buf, swap_word(mss), swap_word(max_mss));
+      } else {
+        tcp_update_checksum(tcp_buf, mss, max_mss);
+      }
+      return 1;
+    }
+    off += len;
+  }
+  return 0;
+}
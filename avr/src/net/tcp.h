@@ -40,6 +40,8 @@
 #define TCP_FLAGS_OFF     12
 #define TCP_WINDOW_OFF    14
 
+#define TCP_MIN_HDR_SIZE  20
+
   // flag masks
 #define TCP_FLAGS_FIN     0x001
 #define TCP_FLAGS_SYN     0x002
@@ -58,5 +60,11 @@ inline u32  tcp_get_seq_num(const u08 *tcp_buf) { return net_get_long(tcp_buf +
 inline u32  tcp_get_ack_num(const u08 *tcp_buf) { return net_get_long(tcp_buf + TCP_ACK_NUM_OFF); }
 inline u16  tcp_get_flags(const u08 *tcp_buf) { return net_get_word(tcp_buf + TCP_FLAGS_OFF) & 0x1ff; }
 inline u16  tcp_get_window_size(const u08 *tcp_buf) { return net_get_word(tcp_buf + TCP_WINDOW_OFF); }
+
+/* update checksum after a word of the segment changed from old_val to new_val */
+extern void tcp_update_checksum(u08 *tcp_buf, u16 old_val, u16 new_val);
+/* lower the MSS option of a SYN segment to max_mss.
+   size is the size of the segment. returns 1 if the MSS was changed */
+extern u08 tcp_clamp_mss(u08 *tcp_buf, u16 size, u16 max_mss);
   
 #endif
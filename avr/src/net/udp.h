@@ -38,6 +38,8 @@
 #define UDP_CHECKSUM_OFF  6
 #define UDP_DATA_OFF      8
 
+#define UDP_PORT_DHCP_CLIENT  68
+
 inline const u08 *udp_get_data_ptr(const u08 *udp_buf) { return udp_buf + UDP_DATA_OFF; }
 inline u16  udp_get_src_port(const u08 *udp_buf) { return net_get_word(udp_buf + UDP_SRC_PORT_OFF); }
 inline u16  udp_get_tgt_port(const u08 *udp_buf) { return net_get_word(udp_buf + UDP_TGT_PORT_OFF); }
@@ -68,7 +68,7 @@ void par_low_data_set_input(void)
   PAR_DATA_HI_DDR &= ~PAR_DATA_HI_MASK;
 }
 #else
-#ifdef HAVE_avrnetio
+#if defined(HAVE_avrnetio) || defined(HAVE_host)
 void par_low_data_set_output(void)
 {
   PAR_DATA_DDR = 0xff;
@@ -86,4 +86,8 @@ void par_low_pulse_ack(u08 delay)
   par_low_set_ack_lo();
   _delay_loop_1(delay);
   par_low_set_ack_hi();
+#ifdef HAVE_host
+  // the Amiga CIA latches the edge: do the same for simulation clients
+  par_sim->ack_pulses++;
+#endif
 }
@@ -166,10 +166,62 @@
 #define PAR_ACK_PIN             PINA
 #define PAR_ACK_DDR             DDRA
                         
+#else
+#ifdef HAVE_host
+
+/*
+    Simulated Parallel Port (host build)
+    All lines live in the shared memory block of par_sim.h and use
+    bit 0 of their byte. Writes to input pull-ups and to the direction
+    of the signal lines go to a dummy register.
+*/
+#include "par_sim.h"
+
+// data
+#define PAR_DATA_PORT           (par_sim->data_out)
+#define PAR_DATA_PIN            (par_sim->data_in)
+#define PAR_DATA_DDR            (par_sim->data_ddr)
+
+// /STROBE (IN)
+#define PAR_STROBE_BIT          0
+#define PAR_STROBE_MASK         _BV(PAR_STROBE_BIT)
+#define PAR_STROBE_PORT         par_sim_dummy
+#define PAR_STROBE_PIN          (par_sim->strobe)
+#define PAR_STROBE_DDR          par_sim_dummy
+
+// SELECT (IN)
+#define PAR_SELECT_BIT          0
+#define PAR_SELECT_MASK         _BV(PAR_SELECT_BIT)
+#define PAR_SELECT_PORT         par_sim_dummy
+#define PAR_SELECT_PIN          (par_sim->select)
+#define PAR_SELECT_DDR          par_sim_dummy
+
+// POUT (IN)
+#define PAR_POUT_BIT            0
+#define PAR_POUT_MASK           _BV(PAR_POUT_BIT)
+#define PAR_POUT_PORT           par_sim_dummy
+#define PAR_POUT_PIN            (par_sim->pout)
+#define PAR_POUT_DDR            par_sim_dummy
+
+// BUSY (OUT)
+#define PAR_BUSY_BIT            0
+#define PAR_BUSY_MASK           _BV(PAR_BUSY_BIT)
+#define PAR_BUSY_PORT           (par_sim->busy)
+#define PAR_BUSY_PIN            (par_sim->busy)
+#define PAR_BUSY_DDR            par_sim_dummy
+
+// /ACK (OUT)
+#define PAR_ACK_BIT             0
+#define PAR_ACK_MASK            _BV(PAR_ACK_BIT)
+#define PAR_ACK_PORT            (par_sim->ack)
+#define PAR_ACK_PIN             (par_sim->ack)
+#define PAR_ACK_DDR             par_sim_dummy
+
 #else
 #error "Unknwon Board"        
 #endif
 #endif
+#endif
 
 // ----- Input Buffer Handling -----
 
@@ -200,7 +252,7 @@ inline u08 par_low_data_in(void)
   return d1 | d2;
 }
 #else
-#ifdef HAVE_avrnetio
+#if defined(HAVE_avrnetio) || defined(HAVE_host)
 inline void par_low_data_out(u08 d)
 {
   PAR_DATA_PORT = d;
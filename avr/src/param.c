@@ -46,13 +46,31 @@ static const param_t PROGMEM default_param = {
   .mac_addr = { 0x1a,0x11,0xaf,0xa0,0x47,0x11},
 
   .flow_ctl = 0,
+  .flow_pause = 3072,
+  .flow_resume = 5120,
   .full_duplex = 0,
+  .proxy_arp = 1,
+  .mss_clamp = 0,
+  .bcast_filter = 0,
+  .bcast_port = { 0, 0 },
+
+  .pb_timeout = 5000,
+  .pb_burst_delay = 0,
+  .eth_bbipg = 0,
+  .eth_ipg = 0,
   
   .test_plen = 1514,
   .test_ptype = 0xfffd,
   .test_ip = { 192,168,2,222 },
   .test_port = 6800,
-  .test_mode = 0
+  .test_mode = 0,
+#ifdef DIAG
+  .test_sweep_begin = 60,
+  .test_sweep_end = 1514,
+  .test_sweep_step = 128,
+  .test_count = 100,
+  .test_interval = 0
+#endif
 };
 
 static void dump_byte(PGM_P str, const u08 val)
@@ -81,6 +99,20 @@ void param_dump(void)
   uart_send_crlf();
   dump_byte(PSTR("fd: full duplex  "), param.full_duplex);
   dump_byte(PSTR("fc: flow control "), param.flow_ctl);
+  dump_word(PSTR("fp: flow pause   "), param.flow_pause);
+  dump_word(PSTR("fr: flow resume  "), param.flow_resume);
+  dump_byte(PSTR("fa: proxy ARP    "), param.proxy_arp);
+  dump_word(PSTR("fm: TCP MSS max  "), param.mss_clamp);
+  dump_byte(PSTR("fb: bcast filter "), param.bcast_filter);
+  dump_word(PSTR("f1: bcast port 1 "), param.bcast_port[0]);
+  dump_word(PSTR("f2: bcast port 2 "), param.bcast_port[1]);
+
+  // timing
+  uart_send_crlf();
+  dump_word(PSTR("bt: pb timeout   "), param.pb_timeout);
+  dump_byte(PSTR("bd: burst delay  "), param.pb_burst_delay);
+  dump_byte(PSTR("eg: eth b2b gap  "), param.eth_bbipg);
+  dump_byte(PSTR("ei: eth ipg      "), param.eth_ipg);
   
   // test
   uart_send_crlf();
@@ -91,6 +123,13 @@ void param_dump(void)
   uart_send_crlf();
   dump_word(PSTR("tp: udp port     "), param.test_port);
   dump_byte(PSTR("tm: test mode    "), param.test_mode);
+#ifdef DIAG
+  dump_word(PSTR("tb: sweep begin  "), param.test_sweep_begin);
+  dump_word(PSTR("te: sweep end    "), param.test_sweep_end);
+  dump_word(PSTR("ts: sweep step   "), param.test_sweep_step);
+  dump_word(PSTR("tc: test count   "), param.test_count);
+  dump_word(PSTR("tw: interval ms  "), param.test_interval);
+#endif
 }
 
 // build check sum for parameter block
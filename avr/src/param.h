@@ -29,17 +29,39 @@
 
 #include "global.h"
 
+// number of UDP ports passed by the broadcast filter
+#define PARAM_BCAST_PORTS   2
+
 typedef struct {
   u08 mac_addr[6];
 
   u08 flow_ctl;
+  u16 flow_pause;
+  u16 flow_resume;
   u08 full_duplex;
+  u08 proxy_arp;
+  u16 mss_clamp;
+  u08 bcast_filter;
+  u16 bcast_port[PARAM_BCAST_PORTS];
+
+  u16 pb_timeout;
+  u08 pb_burst_delay;
+  u08 eth_bbipg;
+  u08 eth_ipg;
 
   u16 test_plen;
   u16 test_ptype;
   u08 test_ip[4];
   u16 test_port;
   u08 test_mode;
+#ifdef DIAG
+  // size sweep and loop test
+  u16 test_sweep_begin;
+  u16 test_sweep_end;
+  u16 test_sweep_step;
+  u16 test_count;
+  u16 test_interval;
+#endif
 } param_t;
   
 extern param_t param;  
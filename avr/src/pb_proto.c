@@ -33,6 +33,7 @@
 #include "stats.h"
 
 #include "uartutil.h"
+#include "trace.h"
 
 // define symbolic names for protocol
 #define SET_RAK         par_low_set_busy_hi
@@ -46,6 +47,8 @@ static pb_proto_proc_func proc_func;
 static u08 *pb_buf;
 static u16 pb_buf_size;
 static u32 trigger_ts;
+static u08 peek_pending;
+static u16 peek_size;
 
 u16 pb_proto_timeout = 5000; // = 500ms in 100us ticks
 
@@ -60,12 +63,18 @@ void pb_proto_init(pb_proto_fill_func ff, pb_proto_proc_func pf, u08 *buf, u16 b
   proc_func = pf;
   pb_buf = buf;
   pb_buf_size = buf_size;
+  peek_pending = 0;
 
   // init signals
   par_low_data_set_input();
   CLR_RAK();
 }
 
+void pb_proto_set_buf(u08 *buf)
+{
+  pb_buf = buf;
+}
+
 u08 pb_proto_get_line_status(void)
 {
   u08 strobe = par_low_get_strobe();
@@ -88,6 +97,22 @@ void pb_proto_request_recv(void)
 {
   par_low_pulse_ack(1);
   trigger_ts = time_stamp;
+  if(global_trace) {
+    trace_event(TRACE_EV_PB_REQ, 0, 0, 0);
+  }
+}
+
+u08 pb_proto_is_peek_pending(void)
+{
+  return peek_pending;
+}
+
+void pb_proto_clear_peek(void)
+{
+  if(peek_pending) {
+    peek_pending = 0;
+    stats_get(STATS_ID_PB_RX)->drop++;
+  }
 }
 
 // ----- HELPER -----
@@ -188,7 +213,8 @@ static u08 cmd_send(u16 *ret_size)
 }
 
 // amiga wants to receive a packet
-static u08 cmd_recv(u16 size, u16 *ret_size)
+// (announce the full size but transfer only data_size bytes)
+static u08 cmd_recv(u16 size, u16 data_size, u16 *ret_size)
 {
   // --- set size hi ----
   u08 status = wait_req(1, PBPROTO_STAGE_SIZE_HI);
@@ -213,7 +239,7 @@ static u08 cmd_recv(u16 size, u16 *ret_size)
   SET_RAK();
   
   // get number of words
-  u16 words = size;
+  u16 words = data_size;
   if(words & 1) {
     words++;
   }
@@ -340,12 +366,21 @@ send_burst_exit:
 
 // at least 2us
 // 3 cycles per call
-#define DELAY _delay_loop_1(6);
+#define DEFAULT_BURST_DELAY   6
+
+#elif (F_CPU == 20000000)
+
+// same time as above
+#define DEFAULT_BURST_DELAY   8
 
 #else
 #error Delay loop not defined for F_CPU
 #endif
 
+u08 pb_proto_burst_delay = 0; // 0=DEFAULT_BURST_DELAY
+
+#define DELAY _delay_loop_1(delay);
+
 static u08 cmd_recv_burst(u16 size, u16 *ret_size)
 {
   u08 hi, lo;
@@ -382,6 +417,7 @@ static u08 cmd_recv_burst(u16 size, u16 *ret_size)
   u08 result = PBPROTO_STATUS_OK;
   u16 i;
   u08 *ptr = pb_buf;
+  u08 delay = pb_proto_burst_delay ? pb_proto_burst_delay : DEFAULT_BURST_DELAY;
 
   // ----- burst loop -----
   // BEGIN TIME CRITICAL
@@ -464,13 +500,23 @@ u08 pb_proto_handle(void)
 
   // fill buffer for recv command
   u16 pkt_size = 0;
-  if((cmd == PBPROTO_CMD_RECV) || (cmd == PBPROTO_CMD_RECV_BURST)) {
-    u08 res = fill_func(pb_buf, pb_buf_size, &pkt_size);
-    if(res != PBPROTO_STATUS_OK) {
-      ps->status = res;
-      return res;
+  if((cmd == PBPROTO_CMD_RECV) || (cmd == PBPROTO_CMD_RECV_BURST) ||
+     (cmd == PBPROTO_CMD_RECV_PEEK)) {
+    // a peeked packet is still waiting in the buffer
+    if(peek_pending) {
+      pkt_size = peek_size;
+    } else {
+      u08 res = fill_func(pb_buf, pb_buf_size, &pkt_size);
+      if(res != PBPROTO_STATUS_OK) {
+        ps->status = res;
+        return res;
+      }
     }
   }
+  // a send overwrites the buffer and loses a peeked packet
+  else if((cmd == PBPROTO_CMD_SEND) || (cmd == PBPROTO_CMD_SEND_BURST)) {
+    pb_proto_clear_peek();
+  }
 
   // start timer
   u32 ts = time_stamp;
@@ -482,17 +528,33 @@ u08 pb_proto_handle(void)
   u16 ret_size = 0;
   switch(cmd) {
     case PBPROTO_CMD_RECV:
-      result = cmd_recv(pkt_size, &ret_size);
+      peek_pending = 0;
+      result = cmd_recv(pkt_size, pkt_size, &ret_size);
       break;
     case PBPROTO_CMD_SEND:
       result = cmd_send(&ret_size);
       break;
     case PBPROTO_CMD_RECV_BURST:
+      peek_pending = 0;
       result = cmd_recv_burst(pkt_size, &ret_size);
       break;
     case PBPROTO_CMD_SEND_BURST:
       result = cmd_send_burst(&ret_size);
       break;
+    case PBPROTO_CMD_RECV_PEEK:
+      result = cmd_recv(pkt_size,
+                        (pkt_size < PBPROTO_PEEK_SIZE) ? pkt_size : PBPROTO_PEEK_SIZE,
+                        &ret_size);
+      // keep packet until the amiga accepts (recv) or skips it
+      peek_pending = (result == PBPROTO_STATUS_OK);
+      peek_size = pkt_size;
+      break;
+    case PBPROTO_CMD_RECV_SKIP:
+      // drop peeked packet without transferring its payload
+      ret_size = peek_pending ? peek_size : 0;
+      peek_pending = 0;
+      result = PBPROTO_STATUS_OK;
+      break;
     default:
       result = PBPROTO_STATUS_INVALID_CMD;
       break;
@@ -53,6 +53,11 @@
 #define PBPROTO_CMD_RECV       0x22   // amiga wants to receive a packet
 #define PBPROTO_CMD_SEND_BURST 0x33
 #define PBPROTO_CMD_RECV_BURST 0x44
+#define PBPROTO_CMD_RECV_PEEK  0x55   // amiga wants to see the header of the next packet
+#define PBPROTO_CMD_RECV_SKIP  0x66   // amiga drops the peeked packet
+
+// number of packet bytes transferred with a peek (ethernet header)
+#define PBPROTO_PEEK_SIZE      14
 
 // line status
 #define PBPROTO_LINE_OFF       0x0
@@ -79,13 +84,19 @@ extern pb_proto_stat_t pb_proto_stat; // filled by pb_proto_handle()
 
 // ----- Parameter -----
 
-extern u16 pb_proto_rx_timeout; // timeout for next byte in 100us
+extern u16 pb_proto_timeout; // timeout for next handshake in 100us
+extern u08 pb_proto_burst_delay; // delay loop count per burst byte (0=default)
 
 // ----- API -----
 
 extern void pb_proto_init(pb_proto_fill_func fill_func, pb_proto_proc_func proc_func, u08 *buf, u16 buf_size);
+// use another buffer of the same size. the fill callback may switch to the
+// buffer of the frame it hands out
+extern void pb_proto_set_buf(u08 *buf);
 extern u08  pb_proto_get_line_status(void);
 extern u08  pb_proto_handle(void); // side effect: fill pb_proto_stat!
 extern void pb_proto_request_recv(void);
+extern u08  pb_proto_is_peek_pending(void); // peeked packet waits for recv or skip
+extern void pb_proto_clear_peek(void); // drop a peeked packet (counted in pb rx drops)
 
 #endif
@@ -27,6 +27,7 @@
 #include "pb_test.h"
 
 #include "uartutil.h"
+#include "uart.h"
 #include "pb_proto.h"
 #include "pb_util.h"
 #include "param.h"
@@ -37,16 +38,60 @@
 #include "net/net.h"
 #include "pkt_buf.h"
 #include "dump.h"
+#include "util.h"
 
 static u08 toggle_request;
 static u08 auto_mode;
 static u08 silent_mode;
 
+#ifdef DIAG
+
+// packet size of the running sweep
+static u16 test_size;
+
+// ----- sweep state -----
+
+#define SWEEP_PHASE_RX  0
+#define SWEEP_PHASE_TX  1
+
+// wait this long (in 10ms) for the Amiga to return a packet
+#define SWEEP_TIMEOUT   100
+
+typedef struct {
+  u16 cnt;
+  u16 err;
+  u32 delta;  // sum of hw timer deltas
+} sweep_phase_t;
+
+static u08 sweep_mode;
+static u16 sweep_left;        // round trips left for this size
+static u16 sweep_last_act;    // timer_10ms of last transfer
+static u32 sweep_start_ts;    // time_stamp at begin of this size
+static u32 sweep_lat;         // sum of recv trigger latencies (100us)
+static sweep_phase_t sweep_phase[2];
+
+#else
+
+// no size sweep without DIAG
+#define sweep_mode  0
+
+#endif
+
 // ----- Packet Callbacks -----
 
+static u16 get_test_size(void)
+{
+#ifdef DIAG
+  if(sweep_mode) {
+    return test_size;
+  }
+#endif
+  return param.test_plen;
+}
+
 static u08 fill_pkt(u08 *buf, u16 max_size, u16 *size)
 {
-  *size = param.test_plen;
+  *size = get_test_size();
   if(*size > max_size) {
     return PBPROTO_STATUS_PACKET_TOO_LARGE;
   }
@@ -77,7 +122,7 @@ static u08 proc_pkt(const u08 *buf, u16 size)
   u16 errors = 0;
 
   // check packet size
-  if(size != param.test_plen) {
+  if(size != get_test_size()) {
     errors = 1;
     uart_send_pstring(PSTR("ERR: size\r\n"));
   }
@@ -133,12 +178,175 @@ static u08 proc_pkt(const u08 *buf, u16 size)
   }
 }
 
+#ifdef DIAG
+
+// ----- size sweep -----
+
+static void send_dec(u32 val, u08 digits, u08 point)
+{
+  u08 buf[8];
+  dword_to_dec(val, buf, digits, point);
+  uart_send_data(buf, (point < digits) ? digits + 1 : digits);
+  uart_send_spc();
+}
+
+static void sweep_send_phase(const sweep_phase_t *p)
+{
+  u16 delta = 0;
+  if(p->cnt > 0) {
+    delta = (u16)(p->delta / p->cnt);
+  }
+  send_dec(p->cnt, 5, 5);
+  send_dec(p->err, 5, 5);
+  uart_send_rate_kbs(timer_hw_calc_rate_kbs(test_size, delta));
+  uart_send_spc();
+  // average transfer time in us
+  send_dec(TIMER_HW_TICKS_TO_US(delta), 6, 6);
+}
+
+static void sweep_dump_header(void)
+{
+  uart_send_pstring(PSTR("size rxcnt rxerr rx rate      rx us  "
+                         "txcnt txerr tx rate      tx us  "
+                         "lat ms rt ms  sustained\r\n"));
+}
+
+static void sweep_dump_size(void)
+{
+  u08 old_drop = uart_set_tx_drop(0);
+  u32 dt = time_stamp - sweep_start_ts;
+  u16 rx_cnt = sweep_phase[SWEEP_PHASE_RX].cnt;
+  u16 rounds = sweep_phase[SWEEP_PHASE_TX].cnt;
+
+  send_dec(test_size, 4, 4);
+  sweep_send_phase(&sweep_phase[SWEEP_PHASE_RX]);
+  sweep_send_phase(&sweep_phase[SWEEP_PHASE_TX]);
+
+  // trigger to recv command and full round trip in 0.1ms
+  send_dec(rx_cnt ? sweep_lat / rx_cnt : 0, 5, 1);
+  send_dec(rounds ? dt / rounds : 0, 5, 1);
+
+  // sustained rate of both directions over wall clock time: KB/s * 100
+  u32 bytes = (u32)(rx_cnt + rounds) * test_size;
+  u32 rate = 0;
+  if(dt > 0) {
+    if(bytes < 4000000UL) {
+      rate = bytes * 1000 / dt;
+    } else {
+      rate = bytes / dt * 1000;
+    }
+  }
+  uart_send_rate_kbs(rate > 0xffff ? 0xffff : (u16)rate);
+  uart_send_crlf();
+  uart_set_tx_drop(old_drop);
+}
+
+static void sweep_begin_size(u16 size)
+{
+  test_size = size;
+  sweep_left = param.test_count;
+  sweep_lat = 0;
+  for(u08 i=0;i<2;i++) {
+    sweep_phase[i].cnt = 0;
+    sweep_phase[i].err = 0;
+    sweep_phase[i].delta = 0;
+  }
+  sweep_start_ts = time_stamp;
+  sweep_last_act = timer_10ms;
+  pb_test_send_packet(1);
+}
+
+static void sweep_end(void)
+{
+  sweep_mode = 0;
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[SWEEP] off\r\n"));
+}
+
+// a round trip is done (or failed): next round, next size or finish
+static void sweep_next_round(void)
+{
+  if(sweep_left > 0) {
+    sweep_left--;
+  }
+  if(sweep_left > 0) {
+    sweep_last_act = timer_10ms;
+    pb_test_send_packet(1);
+    return;
+  }
+
+  sweep_dump_size();
+
+  u16 size = test_size;
+  if(size < param.test_sweep_end) {
+    u16 step = param.test_sweep_step;
+    if((step == 0) || (size + step > param.test_sweep_end)) {
+      size = param.test_sweep_end;
+    } else {
+      size += step;
+    }
+    sweep_begin_size(size);
+  } else {
+    sweep_end();
+  }
+}
+
+static void sweep_account(u08 status)
+{
+  const pb_proto_stat_t *ps = &pb_proto_stat;
+  u08 cmd = ps->cmd;
+
+  // the following recv is accounted
+  if((cmd == PBPROTO_CMD_RECV_PEEK) && (status == PBPROTO_STATUS_OK)) {
+    return;
+  }
+
+  sweep_phase_t *p = &sweep_phase[ps->is_send ? SWEEP_PHASE_TX : SWEEP_PHASE_RX];
+  sweep_last_act = timer_10ms;
+
+  // the Amiga skipped the packet: the round ends without a reply
+  if((status == PBPROTO_STATUS_OK) && (cmd != PBPROTO_CMD_RECV_SKIP)) {
+    p->cnt++;
+    p->delta += ps->delta;
+    if(ps->is_send) {
+      sweep_next_round();
+    } else {
+      sweep_lat += ps->recv_delta;
+    }
+  } else {
+    p->err++;
+    sweep_next_round();
+  }
+}
+
+static void sweep_check_timeout(void)
+{
+  if((u16)(timer_10ms - sweep_last_act) >= SWEEP_TIMEOUT) {
+    // reply was lost
+    sweep_phase[SWEEP_PHASE_TX].err++;
+    sweep_next_round();
+  }
+}
+
+#endif
+
 // ----- function table -----
 
 static void pb_test_worker(void)
 {
   u08 status = pb_util_handle();
 
+#ifdef DIAG
+  if(sweep_mode) {
+    if(status == PBPROTO_STATUS_IDLE) {
+      sweep_check_timeout();
+    } else {
+      sweep_account(status);
+    }
+    return;
+  }
+#endif
+
   // ok!
   if(status == PBPROTO_STATUS_OK) {
 
@@ -178,9 +386,13 @@ u08 pb_test_loop(void)
   auto_mode = 0;
   toggle_request = 0;
   silent_mode = 0;
+#ifdef DIAG
+  sweep_mode = 0;
+#endif
 
   // test loop
   u08 result = CMD_WORKER_IDLE;
+  uart_set_tx_drop(1);
   while(run_mode == RUN_MODE_PB_TEST) {
     // command line handling
     result = cmd_worker();
@@ -191,6 +403,7 @@ u08 pb_test_loop(void)
     pb_test_worker();
   }
 
+  uart_set_tx_drop(0);
   stats_dump(1,0);
 
   uart_send_time_stamp_spc();
@@ -207,6 +420,10 @@ void pb_test_send_packet(u08 silent)
 
 void pb_test_toggle_auto(void)
 {
+  if(sweep_mode) {
+    return;
+  }
+
   auto_mode = !auto_mode;
 
   uart_send_time_stamp_spc();
@@ -225,3 +442,39 @@ void pb_test_toggle_auto(void)
     stats_reset();
   }
 }
+
+#ifdef DIAG
+
+void pb_test_toggle_sweep(void)
+{
+  if(sweep_mode) {
+    sweep_end();
+    return;
+  }
+  if(auto_mode) {
+    pb_test_toggle_auto();
+  }
+
+  u16 begin = param.test_sweep_begin;
+  if((begin < 14) || (begin > param.test_sweep_end) ||
+     (param.test_sweep_end > PKT_BUF_SIZE) || (param.test_count == 0)) {
+    uart_send_pstring(PSTR("[SWEEP] invalid params\r\n"));
+    return;
+  }
+
+  uart_send_time_stamp_spc();
+  uart_send_pstring(PSTR("[SWEEP] on\r\n"));
+  sweep_dump_header();
+
+  sweep_mode = 1;
+  sweep_begin_size(begin);
+}
+
+#else
+
+void pb_test_toggle_sweep(void)
+{
+  uart_send_pstring(PSTR("[SWEEP] not built in\r\n"));
+}
+
+#endif
@@ -33,5 +33,6 @@ extern u08 pb_test_loop(void);
 
 extern void pb_test_toggle_auto(void);
 extern void pb_test_send_packet(u08 silent);
+extern void pb_test_toggle_sweep(void);
 
 #endif
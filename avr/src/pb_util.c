@@ -31,6 +31,14 @@
 #include "stats.h"
 #include "dump.h"
 #include "main.h"
+#include "trace.h"
+#include "param.h"
+
+void pb_util_apply_param(void)
+{
+  pb_proto_timeout = param.pb_timeout;
+  pb_proto_burst_delay = param.pb_burst_delay;
+}
 
 u08 pb_util_handle(void)
 {
@@ -43,10 +51,18 @@ u08 pb_util_handle(void)
 
   const pb_proto_stat_t *ps = &pb_proto_stat;
 
+  if(global_trace) {
+    trace_event_at(ps->cmd, ps->ts, ps->size, status, ps->delta);
+  }
+
   // ok!
   if(status == PBPROTO_STATUS_OK) {
-    // account data
-    stats_update_ok(ps->stats_id, ps->size, ps->rate);
+    // account data (a peek is accounted by the following recv or skip)
+    if(ps->cmd == PBPROTO_CMD_RECV_SKIP) {
+      stats_get(ps->stats_id)->drop++;
+    } else if(ps->cmd != PBPROTO_CMD_RECV_PEEK) {
+      stats_update_ok(ps->stats_id, ps->size, ps->rate);
+    }
     // dump result?
     if(global_verbose) {
       // in interactive mode show result
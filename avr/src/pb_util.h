@@ -30,5 +30,7 @@
 #include "global.h"
 
 extern u08 pb_util_handle(void);
+/* set the tunable protocol parameters */
+extern void pb_util_apply_param(void);
 
 #endif
\ No newline at end of file
@@ -32,12 +32,18 @@
 #ifdef DEV_ENC28J60
 #include "enc28j60.h"
 #endif
+#ifdef DEV_TAP
+#include "tap.h"
+#endif
 
 // the table of available devices
 static const pio_dev_ptr_t PROGMEM devices[] = {
 #ifdef DEV_ENC28J60
   &pio_dev_enc28j60,
 #endif
+#ifdef DEV_TAP
+  &pio_dev_tap,
+#endif
 };
 #define NUM_DEVICES  (sizeof(devices) / sizeof(pio_dev_ptr_t))
 
@@ -93,6 +99,7 @@ void pio_exit(void)
   uart_send_time_stamp_spc();
   uart_send_pstring(PSTR("pio: exit\r\n"));
   pio_dev_exit(cur_dev);
+  cur_dev = 0;
 }
 
 u08 pio_send(const u08 *buf, u16 size)
@@ -105,6 +112,11 @@ u08 pio_recv(u08 *buf, u16 max_size, u16 *got_size)
   return pio_dev_recv(cur_dev, buf, max_size, got_size);
 }
 
+u08 pio_peek(u08 *buf, u16 max_size, u16 *got_size)
+{
+  return pio_dev_peek(cur_dev, buf, max_size, got_size);
+}
+
 u08 pio_has_recv(void)
 {
   return pio_dev_has_recv(cur_dev);
@@ -112,10 +124,27 @@ u08 pio_has_recv(void)
 
 u08 pio_status(u08 status_id, u08 *value)
 {
+  // not initialized yet
+  if(cur_dev == 0) {
+    return PIO_NOT_FOUND;
+  }
   return pio_dev_status(cur_dev, status_id, value);
 }
 
 u08 pio_control(u08 control_id, u08 value)
 {
+  // not initialized yet
+  if(cur_dev == 0) {
+    return PIO_NOT_FOUND;
+  }
   return pio_dev_control(cur_dev, control_id, value);
 }
+
+u08 pio_set_mcast(const u08 *mac_list, u08 num)
+{
+  // not initialized yet
+  if(cur_dev == 0) {
+    return PIO_NOT_FOUND;
+  }
+  return pio_dev_mcast(cur_dev, mac_list, num);
+}
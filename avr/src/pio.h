@@ -44,9 +44,19 @@
 /* status flags */
 #define PIO_STATUS_VERSION      0
 #define PIO_STATUS_LINK_UP      1 
+#define PIO_STATUS_RX_FREE      2   // free rx buffer in 1<<PIO_RX_FREE_SHIFT bytes
+#define PIO_STATUS_TX_BUSY      3   // 1 while a frame is still being sent
+
+#define PIO_RX_FREE_SHIFT       5
 
 /* control ids */
 #define PIO_CONTROL_FLOW        0
+#define PIO_CONTROL_BBIPG       1   // back-to-back inter packet gap (0=default)
+#define PIO_CONTROL_IPG         2   // non back-to-back inter packet gap (0=default)
+
+/* multicast filter */
+#define PIO_MCAST_MAX           32
+#define PIO_MCAST_ALL           0xff
 
 /* --- API --- */
 
@@ -56,8 +66,11 @@ extern void pio_exit(void);
 
 extern u08 pio_send(const u08 *buf, u16 size);
 extern u08 pio_recv(u08 *buf, u16 max_size, u16 *got_size);
+/* copy the head of the next packet without consuming it */
+extern u08 pio_peek(u08 *buf, u16 max_size, u16 *got_size);
 extern u08 pio_has_recv(void);
 extern u08 pio_status(u08 status_id, u08 *value);
 extern u08 pio_control(u08 control_id, u08 value);
+extern u08 pio_set_mcast(const u08 *mac_list, u08 num);
 
 #endif
@@ -35,9 +35,11 @@ typedef u08  (*pio_dev_init_t)(const u08 mac[6],u08 flags);
 typedef void (*pio_dev_exit_t)(void);
 typedef u08  (*pio_dev_send_t)(const u08 *buf, u16 size);
 typedef u08  (*pio_dev_recv_t)(u08 *buf, u16 max_size, u16 *got_size);
+typedef u08  (*pio_dev_peek_t)(u08 *buf, u16 max_size, u16 *got_size);
 typedef u08  (*pio_dev_has_recv_t)(void);
 typedef u08  (*pio_dev_status_t)(u08 status_id, u08 *value);
 typedef u08  (*pio_dev_control_t)(u08 control_id, u08 value);
+typedef u08  (*pio_dev_mcast_t)(const u08 *mac_list, u08 num);
 
 /* device structure */
 typedef struct {
@@ -46,9 +48,11 @@ typedef struct {
   pio_dev_exit_t      exit_f;
   pio_dev_send_t      send_f;
   pio_dev_recv_t      recv_f;
+  pio_dev_peek_t      peek_f;
   pio_dev_has_recv_t  has_recv_f;
   pio_dev_status_t    status_f;
   pio_dev_control_t   control_f;
+  pio_dev_mcast_t     mcast_f;
 } pio_dev_t;
 
 typedef const pio_dev_t *pio_dev_ptr_t;
@@ -84,6 +88,12 @@ inline u08 pio_dev_recv(pio_dev_ptr_t pd, u08 *buf, u16 max_size, u16 *got_size)
   return recv_f(buf, max_size, got_size);
 }
 
+inline u08 pio_dev_peek(pio_dev_ptr_t pd, u08 *buf, u16 max_size, u16 *got_size)
+{
+  pio_dev_peek_t peek_f = (pio_dev_peek_t)pgm_read_word(&pd->peek_f);
+  return peek_f(buf, max_size, got_size);
+}
+
 inline u08 pio_dev_has_recv(pio_dev_ptr_t pd)
 {
   pio_dev_has_recv_t has_recv_f = (pio_dev_has_recv_t)pgm_read_word(&pd->has_recv_f);
@@ -102,4 +112,10 @@ inline u08 pio_dev_control(pio_dev_ptr_t pd, u08 control_id, u08 value)
   return control_f(control_id, value);
 }
 
+inline u08 pio_dev_mcast(pio_dev_ptr_t pd, const u08 *mac_list, u08 num)
+{
+  pio_dev_mcast_t mcast_f = (pio_dev_mcast_t)pgm_read_word(&pd->mcast_f);
+  return mcast_f(mac_list, num);
+}
+
 #endif
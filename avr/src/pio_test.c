@@ -30,6 +30,7 @@
 #include "pio_util.h"
 #include "param.h"
 #include "uartutil.h"
+#include "uart.h"
 #include "main.h"
 #include "stats.h"
 #include "cmd.h"
@@ -42,8 +43,10 @@ u08 pio_test_loop(void)
   uart_send_pstring(PSTR("[PIO_TEST] on\r\n"));
 
   pio_init(param.mac_addr, pio_util_get_init_flags());
+  pio_util_apply_param();
   stats_reset();
   
+  uart_set_tx_drop(1);
   while(run_mode == RUN_MODE_PIO_TEST) {
     // handle commands
     result = cmd_worker();
@@ -69,6 +72,7 @@ u08 pio_test_loop(void)
     }
   }
 
+  uart_set_tx_drop(0);
   stats_dump(0,1);
   pio_exit();
 
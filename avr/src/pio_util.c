@@ -33,6 +33,7 @@
 #include "pkt_buf.h"
 #include "main.h"
 #include "param.h"
+#include "trace.h"
 
 #include "net/net.h"
 #include "net/eth.h"
@@ -54,11 +55,23 @@ u08 pio_util_get_init_flags()
   return flags;
 }
 
+void pio_util_apply_param(void)
+{
+  // devices without these registers simply ignore them
+  pio_control(PIO_CONTROL_BBIPG, param.eth_bbipg);
+  pio_control(PIO_CONTROL_IPG, param.eth_ipg);
+}
+
 u08 pio_util_recv_packet(u16 *size)
+{
+  return pio_util_recv(pkt_buf, size);
+}
+
+u08 pio_util_recv(u08 *buf, u16 *size)
 {
   // measure packet receive
   timer_hw_reset();
-  u08 result = pio_recv(pkt_buf, PKT_BUF_SIZE, size);
+  u08 result = pio_recv(buf, PKT_BUF_SIZE, size);
   u16 delta = timer_hw_get();
 
   u16 s = *size;
@@ -69,6 +82,10 @@ u08 pio_util_recv_packet(u16 *size)
     stats_get(STATS_ID_PIO_RX)->err++;
   }
 
+  if(global_trace) {
+    trace_event(TRACE_EV_PIO_RX, s, result, delta);
+  }
+
   if(global_verbose) {
     uart_send_time_stamp_spc();
     uart_send_pstring(PSTR("pio rx: "));
@@ -91,9 +108,14 @@ u08 pio_util_recv_packet(u16 *size)
 }
 
 u08 pio_util_send_packet(u16 size)
+{
+  return pio_util_send(pkt_buf, size);
+}
+
+u08 pio_util_send(const u08 *buf, u16 size)
 {
   timer_hw_reset();
-  u08 result = pio_send(pkt_buf, size);
+  u08 result = pio_send(buf, size);
   u16 delta = timer_hw_get();
 
   u16 rate = timer_hw_calc_rate_kbs(size, delta);
@@ -103,6 +125,10 @@ u08 pio_util_send_packet(u16 size)
     stats_get(STATS_ID_PIO_TX)->err++;
   }
 
+  if(global_trace) {
+    trace_event(TRACE_EV_PIO_TX, size, result, delta);
+  }
+
   if(global_verbose) {
     uart_send_time_stamp_spc();
     uart_send_pstring(PSTR("pio tx: "));
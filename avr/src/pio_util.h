@@ -32,6 +32,9 @@
 /* get the configured init flags for PIO */
 extern u08 pio_util_get_init_flags(void);
 
+/* set the tunable device parameters. call after pio_init() */
+extern void pio_util_apply_param(void);
+
 /* receive packet from current PIO and store in pkt_buf.
    also update stats and is verbose if enabled.
    only call if pio_has_recv() ist not 0!
@@ -45,6 +48,10 @@ extern u08 pio_util_recv_packet(u16 *size);
 */
 extern u08 pio_util_send_packet(u16 size);
 
+/* same as above for a frame in the given buffer */
+extern u08 pio_util_recv(u08 *buf, u16 *size);
+extern u08 pio_util_send(const u08 *buf, u16 size);
+
 /* check current packet in pkt_buf if its an ARP packet.
    return 1 if its ARP.
    if its an ARP request for me then reply it and
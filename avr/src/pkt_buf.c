@@ -26,4 +26,63 @@
 
 #include "pkt_buf.h"
 
-u08 pkt_buf[PKT_BUF_SIZE];
+u08 pkt_buf[PKT_BUF_NUM * PKT_BUF_SIZE];
+
+// bit mask of free slots
+static u08 free_slots;
+
+void pkt_buf_reset(void)
+{
+  free_slots = 0;
+  for(u08 i=1;i<PKT_BUF_NUM;i++) {
+    free_slots |= (1 << i);
+  }
+}
+
+u08 pkt_buf_alloc(void)
+{
+  for(u08 i=0;i<PKT_BUF_NUM;i++) {
+    if(free_slots & (1 << i)) {
+      free_slots &= ~(1 << i);
+      return i;
+    }
+  }
+  return PKT_BUF_NONE;
+}
+
+void pkt_buf_free(u08 slot)
+{
+  free_slots |= (1 << slot);
+}
+
+void pkt_queue_init(pkt_queue_t *q)
+{
+  q->head = 0;
+  q->num = 0;
+}
+
+void pkt_queue_put(pkt_queue_t *q, u08 slot, u16 size)
+{
+  u08 pos = q->head + q->num;
+  if(pos >= PKT_BUF_NUM) {
+    pos -= PKT_BUF_NUM;
+  }
+  q->slot[pos] = slot;
+  q->size[pos] = size;
+  q->num++;
+}
+
+u08 pkt_queue_get(pkt_queue_t *q, u16 *size)
+{
+  if(q->num == 0) {
+    return PKT_BUF_NONE;
+  }
+  u08 pos = q->head;
+  q->head++;
+  if(q->head == PKT_BUF_NUM) {
+    q->head = 0;
+  }
+  q->num--;
+  *size = q->size[pos];
+  return q->slot[pos];
+}
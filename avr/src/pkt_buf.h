@@ -31,6 +31,44 @@
 
 #define PKT_BUF_SIZE    1514
 
-extern u08 pkt_buf[PKT_BUF_SIZE];
+// number of frame buffers. only parts with more SRAM have more than one
+#ifndef PKT_BUF_NUM
+#define PKT_BUF_NUM     1
+#endif
+#if PKT_BUF_NUM > 8
+#error "PKT_BUF_NUM is limited to 8"
+#endif
+#if PKT_BUF_NUM == 2
+#error "the frame ring needs at least 3 buffers"
+#endif
+
+#define PKT_BUF_NONE    0xff
+
+// all frame buffers in a row. single buffer users work on the first one
+extern u08 pkt_buf[PKT_BUF_NUM * PKT_BUF_SIZE];
+
+inline u08 *pkt_buf_get(u08 slot)
+{
+  return pkt_buf + (u16)slot * PKT_BUF_SIZE;
+}
+
+// a fifo of frames stored in buffer slots
+typedef struct {
+  u08 slot[PKT_BUF_NUM];
+  u16 size[PKT_BUF_NUM];
+  u08 head;
+  u08 num;
+} pkt_queue_t;
+
+// mark all slots free but the first one
+extern void pkt_buf_reset(void);
+// returns a free slot or PKT_BUF_NONE
+extern u08 pkt_buf_alloc(void);
+extern void pkt_buf_free(u08 slot);
+
+extern void pkt_queue_init(pkt_queue_t *q);
+extern void pkt_queue_put(pkt_queue_t *q, u08 slot, u16 size);
+// remove the oldest frame. returns its slot or PKT_BUF_NONE
+extern u08 pkt_queue_get(pkt_queue_t *q, u16 *size);
 
 #endif
@@ -27,9 +27,115 @@
 #include "stats.h"
 #include "uartutil.h"
 #include "uart.h"
+#include "util.h"
+#include "timer.h"
+#include "main.h"
+#include "pb_proto.h"
+#include "pio.h"
+
+// layout of the record of stats_dump_record(). bump on every change
+#define STATS_RECORD_VERSION  2
 
 stats_t stats[STATS_ID_NUM];
 
+#ifdef DIAG
+
+u16 stats_cnt[STATS_CNT_NUM];
+u32 stats_flow_time;
+
+// sliding rate windows: bytes per second of the last STATS_WIN_SLOTS seconds.
+// slots hold 32 byte units to fit in a word (up to 2 MB/s)
+#define STATS_WIN_SLOTS   10
+#define STATS_WIN_SHIFT   5
+
+static u32 win_bytes[STATS_ID_NUM];
+static u16 win_slot[STATS_ID_NUM][STATS_WIN_SLOTS];
+static u08 win_pos;
+static u08 win_valid;
+static u16 win_sec;
+
+// main loop iterations of the current second and the idle share of the last
+static u32 loop_total;
+static u32 loop_idle;
+static u08 idle_pct;
+static u08 idle_valid;
+
+static u16 get_timer_1s(void)
+{
+  // the ISR may change the word while we read it
+  u16 now;
+  do {
+    now = timer_1s;
+  } while(now != timer_1s);
+  return now;
+}
+
+static void win_reset(void)
+{
+  for(u08 i=0;i<STATS_ID_NUM;i++) {
+    win_bytes[i] = 0;
+    for(u08 j=0;j<STATS_WIN_SLOTS;j++) {
+      win_slot[i][j] = 0;
+    }
+  }
+  win_pos = 0;
+  win_valid = 0;
+  win_sec = get_timer_1s();
+
+  loop_total = 0;
+  loop_idle = 0;
+  idle_pct = 0;
+  idle_valid = 0;
+}
+
+// close the current second if the timer moved on
+static u08 win_update(void)
+{
+  u16 now = get_timer_1s();
+  u16 secs = now - win_sec;
+  if(secs == 0) {
+    return 0;
+  }
+  win_sec = now;
+
+  // store the last second and clear the ones without any update
+  if(secs > STATS_WIN_SLOTS) {
+    secs = STATS_WIN_SLOTS;
+  }
+  for(u08 n=0;n<secs;n++) {
+    win_pos++;
+    if(win_pos == STATS_WIN_SLOTS) {
+      win_pos = 0;
+    }
+    for(u08 i=0;i<STATS_ID_NUM;i++) {
+      u16 val = 0;
+      if(n == 0) {
+        u32 units = win_bytes[i] >> STATS_WIN_SHIFT;
+        val = (units > 0xffff) ? 0xffff : (u16)units;
+        win_bytes[i] = 0;
+      }
+      win_slot[i][win_pos] = val;
+    }
+  }
+  win_valid += secs;
+  if(win_valid > STATS_WIN_SLOTS) {
+    win_valid = STATS_WIN_SLOTS;
+  }
+
+  // idle share of the loop. only a running loop gives a value
+  if(loop_total > 0) {
+    idle_pct = (u08)((loop_idle * 100) / loop_total);
+    idle_valid = 1;
+  } else {
+    idle_valid = 0;
+  }
+  loop_total = 0;
+  loop_idle = 0;
+  return 1;
+}
+
+#endif
+
 void stats_reset(void)
 {
   for(u08 i=0;i<STATS_ID_NUM;i++) {
@@ -40,6 +146,13 @@ void stats_reset(void)
     s->drop = 0;
     s->max_rate = 0;
   }
+#ifdef DIAG
+  for(u08 i=0;i<STATS_CNT_NUM;i++) {
+    stats_cnt[i] = 0;
+  }
+  stats_flow_time = 0;
+  win_reset();
+#endif
 }
 
 void stats_update_ok(u08 id, u16 size, u16 rate)
@@ -50,8 +163,81 @@ void stats_update_ok(u08 id, u16 size, u16 rate)
   if(rate > s->max_rate) {
     s->max_rate = rate;
   }
+#ifdef DIAG
+  win_update();
+  win_bytes[id] += size;
+#endif
 }
 
+#ifdef DIAG
+
+u08 stats_worker(void)
+{
+  return win_update();
+}
+
+void stats_loop(u08 busy)
+{
+  loop_total++;
+  if(!busy) {
+    loop_idle++;
+  }
+}
+
+u16 stats_get_win_rate(u08 id, u08 secs)
+{
+  win_update();
+  if(secs > win_valid) {
+    secs = win_valid;
+  }
+  if(secs == 0) {
+    return 0;
+  }
+  u32 sum = 0;
+  u08 pos = win_pos;
+  for(u08 n=0;n<secs;n++) {
+    sum += win_slot[id][pos];
+    pos = (pos == 0) ? (STATS_WIN_SLOTS - 1) : (pos - 1);
+  }
+  // KB/s * 100 like timer_hw_calc_rate_kbs()
+  u32 rate = ((sum << STATS_WIN_SHIFT) / 10) / secs;
+  return (rate > 0xffff) ? 0xffff : (u16)rate;
+}
+
+u08 stats_get_busy(u08 *pct)
+{
+  win_update();
+  if(!idle_valid) {
+    return 0;
+  }
+  *pct = 100 - idle_pct;
+  return 1;
+}
+
+#else
+
+// no rate windows and busy meter: they do not fit the 2 KB parts
+u08 stats_worker(void)
+{
+  return 0;
+}
+
+void stats_loop(u08 busy)
+{
+}
+
+u16 stats_get_win_rate(u08 id, u08 secs)
+{
+  return 0;
+}
+
+u08 stats_get_busy(u08 *pct)
+{
+  return 0;
+}
+
+#endif
+
 static void dump_line(u08 id)
 {
   const stats_t *s = &stats[id];
@@ -88,6 +274,45 @@ static void dump_line(u08 id)
   uart_send_crlf();
 }
 
+#ifdef DIAG
+static void dump_win(void)
+{
+  for(u08 i=0;i<STATS_ID_NUM;i++) {
+    PGM_P str;
+    switch(i) {
+      case STATS_ID_PB_RX:
+        str = PSTR("win pb rx      1s=");
+        break;
+      case STATS_ID_PB_TX:
+        str = PSTR("win pb tx      1s=");
+        break;
+      case STATS_ID_PIO_RX:
+        str = PSTR("win pio rx     1s=");
+        break;
+      default:
+        str = PSTR("win pio tx     1s=");
+        break;
+    }
+    uart_send_pstring(str);
+    uart_send_rate_kbs(stats_get_win_rate(i, 1));
+    uart_send_pstring(PSTR(" 10s="));
+    uart_send_rate_kbs(stats_get_win_rate(i, 10));
+    uart_send_crlf();
+  }
+  uart_send_pstring(PSTR("loop busy      "));
+  u08 pct;
+  if(stats_get_busy(&pct)) {
+    u08 buf[3];
+    dword_to_dec(pct, buf, 3, 3);
+    uart_send_data(buf, 3);
+    uart_send('%');
+  } else {
+    uart_send('-');
+  }
+  uart_send_crlf();
+}
+#endif
+
 static void dump_header(void)
 {
   uart_send_pstring(PSTR("cnt  bytes    err  drop rate\r\n"));  
@@ -99,6 +324,31 @@ void stats_dump_all(void)
   for(u08 i=0;i<STATS_ID_NUM;i++) {
     dump_line(i);
   }
+#ifdef DIAG
+  uart_send_pstring(PSTR("arp proxy      "));
+  uart_send_hex_word(stats_cnt[STATS_CNT_ARP_PROXY]);
+  uart_send_crlf();
+  uart_send_pstring(PSTR("mss clamp      "));
+  uart_send_hex_word(stats_cnt[STATS_CNT_MSS_CLAMP]);
+  uart_send_crlf();
+  uart_send_pstring(PSTR("bcast pass     "));
+  uart_send_hex_word(stats_cnt[STATS_CNT_BCAST_PASS]);
+  uart_send_crlf();
+  uart_send_pstring(PSTR("bcast drop     "));
+  uart_send_hex_word(stats_cnt[STATS_CNT_BCAST_DROP]);
+  uart_send_crlf();
+  uart_send_pstring(PSTR("flow pauses    "));
+  uart_send_hex_word(stats_cnt[STATS_CNT_FLOW_PAUSE]);
+  uart_send_pstring(PSTR(" ms="));
+  u08 buf[10];
+  dword_to_dec(stats_flow_time, buf, 8, 1);
+  uart_send_data(buf, 9);
+  uart_send_crlf();
+  uart_send_pstring(PSTR("uart tx drops  "));
+  uart_send_hex_word(uart_get_tx_drops());
+  uart_send_crlf();
+  dump_win();
+#endif
 }
 
 void stats_dump(u08 pb, u08 pio)
@@ -113,3 +363,93 @@ void stats_dump(u08 pb, u08 pio)
     dump_line(STATS_ID_PIO_TX);
   }
 }
+
+static void rec_byte(u08 val)
+{
+  uart_send(',');
+  uart_send_hex_byte(val);
+}
+
+static void rec_word(u16 val)
+{
+  uart_send(',');
+  uart_send_hex_word(val);
+}
+
+static void rec_dword(u32 val)
+{
+  uart_send(',');
+  uart_send_hex_dword(val);
+}
+
+static void rec_pio_status(u08 id)
+{
+  u08 val;
+  if(pio_status(id, &val) == PIO_OK) {
+    rec_byte(val);
+  } else {
+    uart_send(',');
+  }
+}
+
+void stats_dump_record(void)
+{
+  uart_send_pstring(PSTR("$S"));
+  rec_byte(STATS_RECORD_VERSION);
+  rec_dword(time_stamp);
+  rec_byte(run_mode);
+
+  for(u08 i=0;i<STATS_ID_NUM;i++) {
+    const stats_t *s = &stats[i];
+    rec_word(s->cnt);
+    rec_dword(s->bytes);
+    rec_word(s->err);
+    rec_word(s->drop);
+    rec_word(s->max_rate);
+  }
+  // filter counters (empty without DIAG)
+  for(u08 i=0;i<STATS_CNT_NUM;i++) {
+#ifdef DIAG
+    rec_word(stats_cnt[i]);
+#else
+    uart_send(',');
+#endif
+  }
+#ifdef DIAG
+  rec_dword(stats_flow_time);
+#else
+  uart_send(',');
+#endif
+  rec_word(uart_get_tx_drops());
+
+  // last pb proto command
+  const pb_proto_stat_t *ps = &pb_proto_stat;
+  rec_byte(ps->cmd);
+  rec_byte(ps->status);
+  rec_word(ps->size);
+  rec_word(ps->delta);
+  rec_word(ps->rate);
+  rec_word(ps->recv_delta);
+
+  // ethernet device (empty if unknown)
+  rec_pio_status(PIO_STATUS_LINK_UP);
+  rec_pio_status(PIO_STATUS_RX_FREE);
+
+  // sliding windows and loop load (empty if no loop runs or without DIAG)
+  for(u08 i=0;i<STATS_ID_NUM;i++) {
+#ifdef DIAG
+    rec_word(stats_get_win_rate(i, 1));
+    rec_word(stats_get_win_rate(i, 10));
+#else
+    uart_send(',');
+    uart_send(',');
+#endif
+  }
+  u08 pct;
+  if(stats_get_busy(&pct)) {
+    rec_byte(pct);
+  } else {
+    uart_send(',');
+  }
+  uart_send_crlf();
+}
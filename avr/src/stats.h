@@ -35,6 +35,14 @@
 #define STATS_ID_PIO_TX 3
 #define STATS_ID_NUM    4
 
+// counters of the bridge filters
+#define STATS_CNT_ARP_PROXY  0
+#define STATS_CNT_MSS_CLAMP  1
+#define STATS_CNT_BCAST_PASS 2
+#define STATS_CNT_BCAST_DROP 3
+#define STATS_CNT_FLOW_PAUSE 4
+#define STATS_CNT_NUM        5
+
 typedef struct {
   u32 bytes;
   u16 cnt;
@@ -44,12 +52,37 @@ typedef struct {
 } stats_t;
 
 extern stats_t stats[STATS_ID_NUM];
+#ifdef DIAG
+extern u16 stats_cnt[STATS_CNT_NUM];
+// time the sender was paused by flow control (100us)
+extern u32 stats_flow_time;
+
+inline void stats_count(u08 id)
+{
+  stats_cnt[id]++;
+}
+#else
+// no filter counters on parts without DIAG
+inline void stats_count(u08 id) {}
+#endif
 
 extern void stats_reset(void);
 extern void stats_dump_all(void);
 extern void stats_dump(u08 pb, u08 pio);
+/* one CSV line with all counters for python/pbstats */
+extern void stats_dump_record(void);
 extern void stats_update_ok(u08 id, u16 size, u16 rate);
 
+/* the rate windows and the busy meter are only built with DIAG */
+/* close the rate windows. returns 1 if a second has passed */
+extern u08 stats_worker(void);
+/* call once per main loop iteration. busy=0 if nothing was done */
+extern void stats_loop(u08 busy);
+/* rate of the last 1..10 seconds in KB/s * 100 */
+extern u16 stats_get_win_rate(u08 id, u08 secs);
+/* busy share of the main loop in the last second. 0 if no loop runs */
+extern u08 stats_get_busy(u08 *pct);
+
 inline stats_t *stats_get(u08 id)
 {
   return &stats[id];
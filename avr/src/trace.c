@@ -0,0 +1,96 @@
+/*
+ * trace.c: binary event trace on the serial port
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "trace.h"
+
+#include "uart.h"
+#include "uartutil.h"
+#include "timer.h"
+
+#ifdef DIAG
+
+u08 global_trace = 0;
+
+static u08 trace_seq;
+static u16 trace_drops;
+
+void trace_event_at(u08 id, u32 ts, u16 size, u08 status, u16 delta)
+{
+  u08 rec[TRACE_RECORD_SIZE];
+
+  rec[0] = TRACE_SYNC;
+  rec[1] = id;
+  rec[2] = trace_seq++;
+  rec[3] = (u08)ts;
+  rec[4] = (u08)(ts >> 8);
+  rec[5] = (u08)(ts >> 16);
+  rec[6] = (u08)(ts >> 24);
+  rec[7] = (u08)size;
+  rec[8] = (u08)(size >> 8);
+  rec[9] = status;
+  rec[10] = (u08)delta;
+  rec[11] = (u08)(delta >> 8);
+
+  u08 sum = 0;
+  for(u08 i=1;i<(TRACE_RECORD_SIZE-1);i++) {
+    sum += rec[i];
+  }
+  rec[12] = sum;
+
+  // never wait for the uart: drop the whole record
+  if(!uart_send_nb(rec, TRACE_RECORD_SIZE)) {
+    trace_drops++;
+  }
+}
+
+void trace_event(u08 id, u16 size, u08 status, u16 delta)
+{
+  trace_event_at(id, time_stamp, size, status, delta);
+}
+
+void trace_toggle(void)
+{
+  global_trace = !global_trace;
+  uart_send_pstring(PSTR("TRACE: "));
+  if(global_trace) {
+    trace_seq = 0;
+    trace_drops = 0;
+    uart_send_pstring(PSTR("ON\r\n"));
+  } else {
+    uart_send_pstring(PSTR("OFF drops="));
+    uart_send_hex_word(trace_drops);
+    uart_send_crlf();
+  }
+}
+
+#else
+
+void trace_toggle(void)
+{
+  uart_send_pstring(PSTR("TRACE: not built in\r\n"));
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * trace.h: binary event trace on the serial port
+ *
+ * Written by
+ *  Christian Vogelgsang <chris@vogelgsang.org>
+ *
+ * This file is part of plipbox.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "global.h"
+
+/*
+ * a trace record has 13 bytes (multi byte values are little endian):
+ *
+ *  +0  u08 sync (TRACE_SYNC)
+ *  +1  u08 event id
+ *  +2  u08 sequence number (gaps show dropped records)
+ *  +3  u32 time_stamp at end of event (100us). start for pb commands
+ *  +7  u16 size
+ *  +9  u08 status
+ * +10  u16 duration (ticks of the hw timer: 4us at 16 MHz)
+ * +12  u08 sum of bytes +1..+11
+ *
+ * see python/pbtrace for the decoder
+ */
+#define TRACE_SYNC          0xfe
+#define TRACE_RECORD_SIZE   13
+
+// events. the ids of pb proto commands (0x11..0x66) are used for commands
+#define TRACE_EV_PIO_RX     0x01  // frame received from ethernet
+#define TRACE_EV_PIO_TX     0x02  // frame sent to ethernet
+#define TRACE_EV_PB_REQ     0x03  // Amiga was requested to receive
+#define TRACE_EV_PB_REQ_IGN 0x04  // request ignored: one is pending
+#define TRACE_EV_PIO_DROP   0x05  // frame dropped while offline (size)
+#define TRACE_EV_MAGIC      0x06  // magic frame from Amiga (size=type)
+#define TRACE_EV_ARP_PROXY  0x07  // ARP request answered for the Amiga
+#define TRACE_EV_BCAST_DROP 0x08  // broadcast dropped by filter (size)
+
+#ifdef DIAG
+extern u08 global_trace;
+
+extern void trace_event_at(u08 id, u32 ts, u16 size, u08 status, u16 delta);
+extern void trace_event(u08 id, u16 size, u08 status, u16 delta);
+#else
+// no trace on parts without DIAG: the calls are compiled away
+#define global_trace  0
+inline void trace_event_at(u08 id, u32 ts, u16 size, u08 status, u16 delta) {}
+inline void trace_event(u08 id, u16 size, u08 status, u16 delta) {}
+#endif
+extern void trace_toggle(void);
+
+#endif
@@ -1 +1,2 @@
 from .ethertap import EtherTap
+from .pktring import PacketRing
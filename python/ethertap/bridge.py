@@ -19,7 +19,7 @@ class Bridge:
     """create a new and empty bridge. return error code"""
     if sys.platform == 'darwin':
       ret = self._osh.ifconfig(self._ifname, 'create')
-    elif sys.platform == 'linux2':
+    elif sys.platform.startswith('linux'):
       ret = self._osh.brctl('addbr', self._ifname)
     return ret
 
@@ -27,7 +27,7 @@ class Bridge:
     """add an interface to the bridge"""
     if sys.platform == 'darwin':
       ret = self._osh.ifconfig(self._ifname, 'addm', if_name)
-    elif sys.platform == 'linux2':
+    elif sys.platform.startswith('linux'):
       ret = self._osh.brctl('addif', self._ifname, if_name)
     return ret
 
@@ -35,7 +35,7 @@ class Bridge:
     """remove an interface from the bridge"""
     if sys.platform == 'darwin':
       ret = self._osh.ifconfig(self._ifname, 'deletem', if_name)
-    elif sys.platform == 'linux2':
+    elif sys.platform.startswith('linux'):
       ret = self._osh.brctl('delif', self._ifname, if_name)
     return ret
 
@@ -51,7 +51,7 @@ class Bridge:
     """remove the bridge"""
     if sys.platform == 'darwin':
       ret = self._osh.ifconfig(self._ifname, 'destroy')
-    elif sys.platform == 'linux2':
+    elif sys.platform.startswith('linux'):
       ret = self._osh.brctl('delbr', self._ifname)
     return ret
 
@@ -115,10 +115,23 @@ class EtherTap:
     """read a packet with given max size and optional timeout"""
     return self._tap.read(size, timeout)
 
+  def read_into(self, buf, timeout=None):
+    """read a packet into a preallocated buffer.
+       return its size or None on timeout"""
+    return self._tap.read_into(buf, timeout)
+
   def write(self, buf):
     """write a packet"""
     return self._tap.write(buf)
 
+  def flush(self):
+    """packets are written at once: nothing to do"""
+    pass
+
+  def get_fd(self):
+    """return the file descriptor of the tap for select()"""
+    return self._tap.get_fd()
+
   def __enter__(self):
     """for use in 'with'"""
     self.open()
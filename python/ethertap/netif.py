@@ -118,13 +118,13 @@ class NetIf:
     result = []
     for ifname in ifnames:
       entry = ifs[ifname]
-      if entry.has_key('active'):
+      if 'active' in entry:
         entry_active = entry['active']
         if entry_active == active:
           # active state matches
-          entry_configured = entry.has_key('inet') and \
-                             entry.has_key('netmask') and \
-                             entry.has_key('broadcast')
+          entry_configured = 'inet' in entry and \
+                             'netmask' in entry and \
+                             'broadcast' in entry
           if entry_configured == configured_ip:
             # return only zero ips
             if entry_configured and only_zero_ip:
@@ -135,7 +135,7 @@ class NetIf:
     return result
 
   def if_is_configured(self, entry):
-    return entry.has_key('inet') and entry.has_key('netmask') and entry.has_key('broadcast')
+    return 'inet' in entry and 'netmask' in entry and 'broadcast' in entry
 
   def if_up(self, name):
     """try to bring up interface. return exitcode of ifconfig call"""
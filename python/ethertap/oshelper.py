@@ -26,7 +26,7 @@ class OSHelper:
     # check for platform specific tools
     if sys.platform == 'darwin':
       pass
-    elif sys.platform == 'linux2':
+    elif sys.platform.startswith('linux'):
       self._brctl = '/sbin/brctl'
       self._tunctl = '/usr/sbin/tunctl'
       self._tools.append(self._brctl)
@@ -63,7 +63,7 @@ class OSHelper:
     full_cmd = self._get_cmd(cmd, args)
     p = subprocess.Popen(full_cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
     (stdout, stderr) = p.communicate()
-    return (p.returncode, stdout)
+    return (p.returncode, stdout.decode('ascii', 'replace'))
   
   def ifconfig(self, *args):
     """call ifconfig with the given set of parameters"""
@@ -74,13 +74,13 @@ class OSHelper:
 
   def brctl(self, *args):
     """call brctl with the given set of parameters"""
-    if sys.platform != 'linux2':
+    if not sys.platform.startswith('linux'):
       raise OSHelperError("'brctl' not supported on this platform")
     return self._run(self._brctl, args)
 
   def tunctl(self, *args):
     """call tunctl with the given set of parameters"""
-    if sys.platform != 'linux2':
+    if not sys.platform.startswith('linux'):
       raise OSHelperError("'tunctl' not supported on this platform")
     return self._run(self._tunctl, args)
 
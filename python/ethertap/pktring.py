@@ -0,0 +1,279 @@
+from __future__ import print_function
+import os
+import sys
+import mmap
+import fcntl
+import ctypes
+import select
+import socket
+import struct
+
+class PacketRingError(Exception):
+  """errors raised while setting up the packet ring"""
+  pass
+
+# from linux/if_packet.h and friends
+SOL_PACKET = 263
+PACKET_ADD_MEMBERSHIP = 1
+PACKET_RX_RING = 5
+PACKET_VERSION = 10
+PACKET_TX_RING = 13
+PACKET_MR_PROMISC = 1
+TPACKET_V3 = 2
+SO_ATTACH_FILTER = 26
+SIOCGIFINDEX = 0x8933
+ETH_P_ALL = 3
+
+TP_STATUS_KERNEL = 0
+TP_STATUS_USER = 1
+TP_STATUS_AVAILABLE = 0
+TP_STATUS_SEND_REQUEST = 1
+TP_STATUS_SENDING = 2
+TP_STATUS_WRONG_FORMAT = 4
+
+# offsets in struct tpacket_block_desc (with tpacket_hdr_v1)
+BLK_STATUS = 8
+BLK_NUM_PKTS = 12
+BLK_FIRST_PKT = 16
+
+# offsets in struct tpacket3_hdr
+HDR_NEXT = 0
+HDR_SNAPLEN = 12
+HDR_LEN = 16
+HDR_STATUS = 20
+HDR_MAC = 24
+# frame data of tx slots starts right after the aligned header
+TX_DATA_OFF = 48
+
+
+def mac_filter(mac):
+  """classic BPF program accepting frames for mac or any group address"""
+  hi = struct.unpack("!I", mac[0:4])[0]
+  lo = struct.unpack("!H", mac[4:6])[0]
+  prog = [
+    (0x30, 0, 0, 0),          # ldb [0]
+    (0x45, 4, 0, 1),          # jset #1 -> accept (broad/multicast)
+    (0x20, 0, 0, 0),          # ld [0]
+    (0x15, 0, 3, hi),         # jeq #hi else drop
+    (0x28, 0, 0, 4),          # ldh [4]
+    (0x15, 0, 1, lo),         # jeq #lo else drop
+    (0x06, 0, 0, 0x40000),    # accept: ret #0x40000
+    (0x06, 0, 0, 0),          # drop: ret #0
+  ]
+  return b"".join(struct.pack("HBBI", *ins) for ins in prog)
+
+
+class PacketRing:
+  """exchange frames with an ethernet interface through a TPACKET_V3
+     mmap ring of an AF_PACKET socket (Linux only).
+
+     no tap and bridge are needed: the socket is bound to the interface
+     itself. the interface is put into promiscuous mode and if a mac is
+     given only frames for it and group frames pass the kernel filter.
+     received frames are taken from ring blocks without a syscall and
+     transmits are queued in the tx ring until flush() is called.
+  """
+
+  def __init__(self, eth_if, mac=None, block_size=1 << 16, block_nr=8,
+               frame_size=2048, tx_frame_nr=64, block_tmo=10):
+    # mac is either 6 raw bytes or "xx:xx:xx:xx:xx:xx"
+    if mac is not None and len(mac) != 6:
+      mac = bytes(bytearray(int(x, 16) for x in mac.split(':')))
+    self.eth_if = eth_if
+    self.mac = mac
+    self._block_size = block_size
+    self._block_nr = block_nr
+    self._frame_size = frame_size
+    self._tx_frame_nr = tx_frame_nr
+    self._block_tmo = block_tmo
+    self._sock = None
+    self._map = None
+
+  def open(self):
+    if not sys.platform.startswith('linux'):
+      raise NotImplementedError("packet ring needs Linux!")
+    try:
+      s = socket.socket(socket.AF_PACKET, socket.SOCK_RAW,
+                        socket.htons(ETH_P_ALL))
+    except socket.error as e:
+      raise PacketRingError("can't create packet socket: %s" % e)
+    self._sock = s
+    try:
+      self._setup()
+    except (socket.error, IOError, OSError) as e:
+      self.close()
+      raise PacketRingError("setup of %s failed: %s" % (self.eth_if, e))
+
+  def _setup(self):
+    s = self._sock
+    # filter first so no foreign frames end up in the ring
+    if self.mac is not None:
+      self._attach_filter(mac_filter(self.mac))
+    s.setsockopt(SOL_PACKET, PACKET_VERSION, TPACKET_V3)
+    # rx ring: blocks are retired by the kernel when full or after tmo
+    rx_frames = self._block_nr * (self._block_size // self._frame_size)
+    s.setsockopt(SOL_PACKET, PACKET_RX_RING,
+                 struct.pack("IIIIIII", self._block_size, self._block_nr,
+                             self._frame_size, rx_frames,
+                             self._block_tmo, 0, 0))
+    # tx ring: plain array of frame slots
+    per_block = self._block_size // self._frame_size
+    tx_blocks = (self._tx_frame_nr + per_block - 1) // per_block
+    self._tx_frame_nr = tx_blocks * per_block
+    s.setsockopt(SOL_PACKET, PACKET_TX_RING,
+                 struct.pack("IIIIIII", self._block_size, tx_blocks,
+                             self._frame_size, self._tx_frame_nr, 0, 0, 0))
+    self._rx_size = self._block_size * self._block_nr
+    size = self._rx_size + self._block_size * tx_blocks
+    self._map = mmap.mmap(s.fileno(), size, mmap.MAP_SHARED,
+                          mmap.PROT_READ | mmap.PROT_WRITE)
+    try:
+      self._view = memoryview(self._map)
+    except TypeError:
+      # python 2 mmap has no buffer interface: slice the map itself
+      self._view = self._map
+    s.bind((self.eth_if, ETH_P_ALL))
+    # see frames for the plipbox mac, too
+    ifreq = fcntl.ioctl(s.fileno(), SIOCGIFINDEX,
+                        struct.pack("16sI", self.eth_if.encode('ascii'), 0))
+    ifindex = struct.unpack("16sI", ifreq)[1]
+    s.setsockopt(SOL_PACKET, PACKET_ADD_MEMBERSHIP,
+                 struct.pack("iHH8s", ifindex, PACKET_MR_PROMISC, 0, b""))
+    # rx state
+    self._blk = 0
+    self._blk_pkts = 0
+    self._pkt_off = 0
+    # tx state
+    self._tx_slot = 0
+    self._tx_pending = 0
+
+  def _attach_filter(self, prog):
+    buf = ctypes.create_string_buffer(prog)
+    fprog = struct.pack("HP", len(prog) // 8, ctypes.addressof(buf))
+    self._sock.setsockopt(socket.SOL_SOCKET, SO_ATTACH_FILTER, fprog)
+
+  def close(self):
+    if self._sock is not None and self._map is not None:
+      self.flush()
+    if self._map is not None:
+      self._view = None
+      self._map.close()
+      self._map = None
+    if self._sock is not None:
+      self._sock.close()
+      self._sock = None
+    return 0
+
+  def get_fd(self):
+    return self._sock.fileno()
+
+  def _u32(self, off):
+    return struct.unpack_from("I", self._map, off)[0]
+
+  def _set_u32(self, off, val):
+    struct.pack_into("I", self._map, off, val)
+
+  def _next_pkt(self, timeout):
+    """return offset of next rx frame header or None on timeout"""
+    if self._blk_pkts == 0:
+      blk_off = self._blk * self._block_size
+      if self._u32(blk_off + BLK_STATUS) & TP_STATUS_USER == 0:
+        if timeout is not None and timeout == 0:
+          return None
+        ready = select.select([self._sock], [], [], timeout)[0]
+        if len(ready) == 0:
+          return None
+        if self._u32(blk_off + BLK_STATUS) & TP_STATUS_USER == 0:
+          return None
+      self._blk_pkts = self._u32(blk_off + BLK_NUM_PKTS)
+      self._pkt_off = blk_off + self._u32(blk_off + BLK_FIRST_PKT)
+      if self._blk_pkts == 0:
+        self._release_block()
+        return None
+    off = self._pkt_off
+    self._pkt_off += self._u32(off + HDR_NEXT)
+    self._blk_pkts -= 1
+    return off
+
+  def _release_block(self):
+    self._set_u32(self._blk * self._block_size + BLK_STATUS,
+                  TP_STATUS_KERNEL)
+    self._blk = (self._blk + 1) % self._block_nr
+
+  def read_into(self, buf, timeout=None):
+    """copy next frame into the given buffer. return size or None"""
+    off = self._next_pkt(timeout)
+    if off is None:
+      return None
+    size = self._u32(off + HDR_SNAPLEN)
+    data = off + struct.unpack_from("H", self._map, off + HDR_MAC)[0]
+    size = min(size, len(buf))
+    buf[:size] = self._view[data:data + size]
+    # whole block consumed: hand it back
+    if self._blk_pkts == 0:
+      self._release_block()
+    return size
+
+  def read(self, size=2048, timeout=None):
+    """read a frame with given max size and optional timeout"""
+    buf = bytearray(size)
+    n = self.read_into(buf, timeout)
+    if n is None:
+      return None
+    return bytes(buf[:n])
+
+  def _slot_off(self, slot):
+    per_block = self._block_size // self._frame_size
+    return self._rx_size + (slot // per_block) * self._block_size + \
+           (slot % per_block) * self._frame_size
+
+  def write(self, buf, flush=False):
+    """queue a frame in the tx ring. it is sent with the next flush()"""
+    size = len(buf)
+    if size > self._frame_size - TX_DATA_OFF:
+      raise PacketRingError("frame too large: %d" % size)
+    off = self._slot_off(self._tx_slot)
+    status = self._u32(off + HDR_STATUS)
+    if status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING):
+      # ring is full: let the kernel drain it first
+      self.flush()
+      status = self._u32(off + HDR_STATUS)
+      if status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING):
+        return 0
+    data = off + TX_DATA_OFF
+    if self._view is self._map and isinstance(buf, memoryview):
+      buf = buf.tobytes()
+    self._view[data:data + size] = buf
+    self._set_u32(off + HDR_LEN, size)
+    self._set_u32(off + HDR_SNAPLEN, size)
+    self._set_u32(off + HDR_STATUS, TP_STATUS_SEND_REQUEST)
+    self._tx_slot = (self._tx_slot + 1) % self._tx_frame_nr
+    self._tx_pending += 1
+    if flush:
+      self.flush()
+    return size
+
+  def flush(self):
+    """send all frames queued in the tx ring with one syscall"""
+    if self._tx_pending > 0:
+      self._tx_pending = 0
+      self._sock.send(b"")
+
+  def __enter__(self):
+    """for use in 'with'"""
+    self.open()
+    return self
+
+  def __exit__(self, type, value, traceback):
+    """for use in 'with'"""
+    self.close()
+
+
+# ----- test -----
+if __name__ == '__main__':
+  # try: ip link add vpb0 type veth peer name vpb1
+  with PacketRing(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else None) as r:
+    while True:
+      pkt = r.read(timeout=1)
+      if pkt is not None:
+        print(len(pkt), " ".join("%02x" % b for b in bytearray(pkt[:14])))
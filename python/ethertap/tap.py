@@ -1,6 +1,7 @@
 from __future__ import print_function
 import sys
 import os
+import io
 import fcntl
 import struct
 import select
@@ -27,8 +28,9 @@ class Tap:
       if not os.path.exists(self._name):
         return -1
       self._fd = os.open(self._name, os.O_RDWR)
+      self._file = io.FileIO(self._fd, 'r', closefd=False)
       return self._fd
-    elif sys.platform == 'linux2':
+    elif sys.platform.startswith('linux'):
       # Linux needs 'tunctl' tool and user needs sudo access
       ret = self._osh.tunctl('-t', self._ifname,'-u', str(os.getuid()))
       if ret != 0:
@@ -43,15 +45,16 @@ class Tap:
       IFF_NO_PI = 0x1000
       self._fd = os.open('/dev/net/tun', os.O_RDWR)
       fcntl.ioctl(self._fd, TUNSETIFF,
-                  struct.pack("16sH", self._ifname,
+                  struct.pack("16sH", self._ifname.encode('ascii'),
                               IFF_TAP | IFF_NO_PI))
+      self._file = io.FileIO(self._fd, 'r', closefd=False)
       return self._fd
     else:
       raise NotImplementedError("unsupported platform!")
 
   def close(self):
     os.close(self._fd)
-    if sys.platform == 'linux2':
+    if sys.platform.startswith('linux'):
       # use 'tunctl' to remove tap
       ret = self._osh.tunctl('-d', self._ifname)
       return ret
@@ -65,6 +68,14 @@ class Tap:
         return None
     return os.read(self._fd, size)
 
+  def read_into(self, buf, timeout=None):
+    """read a packet into the given buffer. return size or None"""
+    if timeout is not None:
+      ready = select.select([self._fd], [], [], timeout)[0]
+      if len(ready) == 0:
+        return None
+    return self._file.readinto(buf)
+
   def write(self, buf):
     return os.write(self._fd, buf)
 
@@ -1,5 +1,8 @@
 import struct
 
+# largest frame handled without growing buffers (PKT_BUF_SIZE of firmware)
+MAX_FRAME = 1514
+
 class MacAddress:
     bcast_mac = (0xff, 0xff, 0xff, 0xff, 0xff, 0xff)
 
@@ -40,7 +43,7 @@ class EthFrame:
     def is_bootp_bcast(self):
         eth_off = 14
           # check IP proto
-        proto = ord(self.raw_buf[eth_off+9])
+        proto = struct.unpack_from("B", self.raw_buf, eth_off+9)[0]
         if proto != 17:  # must be UDP
             return False
         # check tgt ip
@@ -49,7 +52,8 @@ class EthFrame:
         if tgt_ip != (255, 255, 255, 255):
             return False
         # check udp port
-        udp_off = eth_off + (ord(self.raw_buf[eth_off]) & 0xf) * 4
+        ihl = struct.unpack_from("B", self.raw_buf, eth_off)[0]
+        udp_off = eth_off + (ihl & 0xf) * 4
         src_port = struct.unpack("!H", self.raw_buf[udp_off:udp_off+2])[0]
         tgt_port = struct.unpack("!H", self.raw_buf[udp_off+2:udp_off+4])[0]
         bootp = (67, 68)
@@ -1,14 +1,22 @@
 from __future__ import print_function
-import reader
-import ethertap
 import logging
+import ethertap
+from . import reader
+from .ethframe import MAX_FRAME
 
 class EthernetReader(reader.Reader):
 
-  def __init__(self, quit_event, tap_if, **kwargs):
-    reader.Reader.__init__(self, "eth", quit_event, **kwargs)
+  def __init__(self, tap_if, ring=False, mac=None, **kwargs):
+    reader.Reader.__init__(self, "eth", **kwargs)
     self.tap_if = tap_if
-    self.et = ethertap.EtherTap(tap_if)
+    if ring:
+      # bind directly to the interface: no tap and bridge
+      self.et = ethertap.PacketRing(tap_if, mac)
+    else:
+      self.et = ethertap.EtherTap(tap_if)
+    # reused for every packet read from the tap
+    self._buf = bytearray(MAX_FRAME)
+    self._view = memoryview(self._buf)
   
   def open(self):
     self._log.debug("+open ethernet")
@@ -19,18 +27,24 @@ class EthernetReader(reader.Reader):
     self._log.debug("+close ethernet")
     self.et.close()
     self._log.debug("-close ethernet")
-  
+
+  def get_fd(self):
+    return self.et.get_fd()
+
   def _get_pkt(self):
-    self._log.debug("+get_pkt")
-    pkt = self.et.read(timeout=self.timeout)
-    self._log.debug("-get_pkt")
-    if pkt is None:
+    """return a view of the internal buffer. valid until next call"""
+    size = self.et.read_into(self._view, timeout=0)
+    if size is None:
       return None
     else:
-      self._log.info("got pkt: {0}".format(len(pkt)))
-      return pkt
+      if self._log.isEnabledFor(logging.INFO):
+        self._log.info("got pkt: {0}".format(size))
+      return self._view[:size]
 
   def send(self, pkt):
-    self._log.debug("+send_pkt: {0}".format(len(pkt)))
+    if self._log.isEnabledFor(logging.DEBUG):
+      self._log.debug("send_pkt: {0}".format(len(pkt)))
     self.et.write(pkt)
-    self._log.debug("-send_pkt")
+
+  def flush(self):
+    self.et.flush()
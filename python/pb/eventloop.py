@@ -0,0 +1,64 @@
+from __future__ import print_function
+import logging
+import select
+
+class EventLoop:
+  """bridge the ethernet tap and the vpar link in a single thread.
+
+     both file descriptors are waited on with select(). the tap is only
+     read while the tx queue towards the Amiga has room, otherwise the
+     frames stay in the kernel until the Amiga has fetched some.
+  """
+
+  def __init__(self, eth, par, **kwargs):
+    self._log = logging.getLogger("loop")
+    if "level" in kwargs:
+      self._log.setLevel(kwargs['level'])
+    self.eth = eth
+    self.par = par
+    self.timeout = 1
+
+  def run(self, quit_event=None):
+    """run until a reader wants to quit or quit_event is set"""
+    self._log.debug("++ run")
+    eth_fd = self.eth.get_fd()
+    par_fd = self.par.get_fd()
+    try:
+      self._loop(eth_fd, par_fd, quit_event)
+    finally:
+      # frames still queued for the ethernet side
+      self.eth.flush()
+    self._log.debug("-- run")
+
+  def _loop(self, eth_fd, par_fd, quit_event):
+    while quit_event is None or not quit_event.is_set():
+      # send what the last pass queued with a single kick
+      self.eth.flush()
+      self.par.flush()
+      # syncing blocks until the emulator answers or times out
+      if self.par.need_sync:
+        if self._forward(self.par, self.eth) is False:
+          break
+        continue
+      # backpressure: leave frames in the tap if the Amiga is behind
+      fds = [par_fd]
+      if self.par.can_send():
+        fds.append(eth_fd)
+      try:
+        ready = select.select(fds, [], [], self.timeout)[0]
+      except select.error:
+        continue
+      if par_fd in ready:
+        if self._forward(self.par, self.eth) is False:
+          break
+      if eth_fd in ready:
+        if self._forward(self.eth, self.par) is False:
+          break
+
+  def _forward(self, src, dst):
+    pkt = src._get_pkt()
+    if pkt is False:
+      return False
+    elif pkt is not None:
+      dst.send(pkt)
+    return True
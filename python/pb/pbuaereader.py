@@ -1,21 +1,34 @@
 from __future__ import print_function
-import reader
-import pbuae
-import Queue
+import collections
 import logging
-import ethframe
+import time
+import pbuae
+from . import reader
+from . import ethframe
 
 class PBUAEReader(reader.Reader):
 
-  def __init__(self, quit_event, pty_name, **kwargs):
-    reader.Reader.__init__(self, "PAR", quit_event, **kwargs)
+  # commands that take a packet from the tx queue
+  RECV_CMDS = (pbuae.PBProto.CMD_RECV, pbuae.PBProto.CMD_RECV_BURST,
+               pbuae.PBProto.CMD_RECV_SKIP)
+  # trigger the ACK again if the Amiga did not fetch the packet in time (s)
+  ACK_TIMEOUT = 1.0
+
+  def __init__(self, pty_name, queue_size=16, **kwargs):
+    reader.Reader.__init__(self, "PAR", **kwargs)
     self.pty_name = pty_name
     self.sopty = pbuae.SoPTY(pty_name)
-    self.vpar = pbuae.VPar(self.sopty)
+    self.vpar = pbuae.VPar(self.sopty, kwargs.get('pipeline', False))
     self.pbproto = pbuae.PBProto(self.vpar)
     if 'level' in kwargs:
       self.pbproto._log.setLevel(kwargs['level'])
-    self.pkt_queue = Queue.Queue()
+    # packets waiting for the Amiga
+    self.queue_size = queue_size
+    self.tx_queue = collections.deque()
+    self.tx_drops = 0
+    # ACK was triggered and the Amiga has not fetched the packet yet
+    self.ack_pending = False
+    self.ack_time = 0
     self.need_sync = True
     self.first_try = True
     self.online = False
@@ -31,23 +44,52 @@ class PBUAEReader(reader.Reader):
     self.pbproto.close()
     self._log.debug("-close pbproto")
 
+  def get_fd(self):
+    return self.sopty.get_fd()
+
+  def can_send(self):
+    """is there room in the tx queue?"""
+    return len(self.tx_queue) < self.queue_size
+
   def _recv_cmd(self):
     """data will be received from Amiga"""
-    pkt = self.pkt_queue.get()
-    self._log.debug("AMIGA recv:")
-    return pkt
-    
+    if len(self.tx_queue) == 0:
+      return None
+    return self.tx_queue.popleft()
+
   def _send_cmd(self, data):
-    """data was sent from Amiga"""
-    self._log.debug("AMIGA send: {}".format(len(data)))
+    """data was sent from Amiga. view is valid until next handle()"""
     self._send_pkt = data
 
+  def _kick(self):
+    """trigger ACK if a packet waits and the Amiga is not busy with one"""
+    if not self.ack_pending and len(self.tx_queue) > 0:
+      self.ack_pending = True
+      self.ack_time = time.time()
+      self.pbproto.request_recv()
+
+  def flush(self):
+    """a lost ACK must not stall the tx queue: trigger it again"""
+    if self.ack_pending and time.time() - self.ack_time > self.ACK_TIMEOUT:
+      self._log.info("no recv after ACK: trigger again")
+      self.ack_pending = False
+      self._kick()
+
+  def _go_offline(self):
+    self.online = False
+    self.ack_pending = False
+    self.tx_queue.clear()
+
   def send(self, data):
     if not self.online:
       self._log.debug("ignore send - not online!")
+    elif not self.can_send():
+      self.tx_drops += 1
+      self._log.info("tx queue full: drop packet")
     else:
-      self.pkt_queue.put(data)
-      self.pbproto.request_recv()
+      # data is a view of the reader's buffer: keep a copy
+      self.tx_queue.append(data.tobytes())
+      self._kick()
 
   def _get_pkt(self):
     try:
@@ -61,28 +103,39 @@ class PBUAEReader(reader.Reader):
           self.need_sync = False
         else:
           return None
-      # try to handle pb
+      # handle all pending state updates
       self._send_pkt = None
-      result = self.pbproto.handle()
-      self._log.debug("handle: {}".format(result))
+      result = self.pbproto.handle(timeout=0)
+      if self._log.isEnabledFor(logging.DEBUG):
+        self._log.debug("handle: {}".format(result))
       if result is False:
         # end -> resync
         print("lost sync")
         self.need_sync = True
         self.first_try = True
-        self.online = False
+        self._go_offline()
+        return None
+      elif result is None:
         return None
-      elif self._send_pkt is not None:
+      # packet was taken: announce next one
+      if result[0] in self.RECV_CMDS:
+        self.ack_pending = False
+        self._kick()
+      if self._send_pkt is not None:
         # got packet
         pkt = self._send_pkt
         ef = ethframe.EthFrame(pkt)
         if ef.is_magic_online():
           print("online")
           self.online = True
+          # the Amiga (re)started: an ACK of before is lost
+          self.ack_pending = False
+          self.tx_queue.clear()
+          self._kick()
           return None
         elif ef.is_magic_offline():
           print("offline")
-          self.online = False
+          self._go_offline()
           return None
         else:
           return pkt
@@ -92,4 +145,4 @@ class PBUAEReader(reader.Reader):
       print(e)
       self.need_sync = True
       self.first_try = True
-      self.online = False
+      self._go_offline()
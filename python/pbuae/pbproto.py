@@ -1,7 +1,12 @@
 from __future__ import print_function
 import logging
 import time
-import vpar
+from . import vpar
+
+try:
+  range = xrange
+except NameError:
+  pass
 
 
 class PBProtoError(Exception):
@@ -15,6 +20,16 @@ class PBProto:
   # commands
   CMD_SEND = 0x11
   CMD_RECV = 0x22
+  CMD_SEND_BURST = 0x33
+  CMD_RECV_BURST = 0x44
+  CMD_RECV_PEEK = 0x55
+  CMD_RECV_SKIP = 0x66
+
+  # number of header bytes transferred by a peek
+  PEEK_SIZE = 14
+
+  # initial size of frame buffers (same as PKT_BUF_SIZE of firmware)
+  MAX_FRAME = 1514
 
   # control lines
   SEL = vpar.SEL_MASK     # in
@@ -28,6 +43,11 @@ class PBProto:
     self._send_pkt_func = None
     self._recv_pkt_func = None
     self._in_sync = False
+    self._debug = False
+    self._peek_size = None
+    # frame buffers are reused for all commands
+    self._rx_buf = bytearray(self.MAX_FRAME)
+    self._tx_buf = bytearray(self.MAX_FRAME)
 
   def set_packet_handler(self, recv_pkt_func, send_pkt_func):
     """set functions that handle the incoming/outgoing packets.
@@ -35,6 +55,9 @@ class PBProto:
 
        recv_pkt() -> data: Amiga wants to receive a packet
        send_pkt(data) -> Amiga wants to send a packet
+
+       data passed to send_pkt is a memoryview of an internal buffer.
+       it is only valid during the call.
     """
     self._send_pkt_func = send_pkt_func
     self._recv_pkt_func = recv_pkt_func
@@ -62,24 +85,29 @@ class PBProto:
       self._in_sync = True
       return True
 
-  def handle(self):
+  def handle(self, timeout=None):
     """main entry to handle the plipbox protocol on the vpar link.
        it will try to process one command and then returns the command.
        if the command is valid it will trigger the packet handler functions
        set above.
 
        call will block until something has happened or timeout occurred.
+       with timeout=0 it only processes the state updates already
+       available. a command is always handled completely.
 
        returns: False - not connected
                 None - timeout
-                <cmd_value> - handled command
+                (cmd, size) - handled command and its packet size
        raises: PBProtoError if sync was lost or fatal protocol error
     """
     # must be in sync
     if not self._in_sync:
       return False
 
-    self._log.debug("enter handle() loop")
+    # only format debug output if it is shown
+    self._debug = self._log.isEnabledFor(logging.DEBUG)
+    if self._debug:
+      self._log.debug("enter handle() loop")
     while True:
       # emu init?
       if self._vpar.check_init_flag():
@@ -95,15 +123,17 @@ class PBProto:
 
       # we need to react if the Amiga has triggered SEL = 1
       if self._vpar.peek_control() & self.SEL == self.SEL:
-        self._log.debug("got SEL")
+        if self._debug:
+          self._log.debug("got SEL")
         return self._handle_cmd()
 
       # request a current state (block until state updates)
-      ok = self._vpar.poll_state()
+      ok = self._vpar.poll_state(timeout)
       if not ok:
         # timeout occurred
         return None 
-      self._log.debug("got state: ctl=%02x dat=%02x" % (self._vpar.peek_control(), self._vpar.peek_data()))
+      if self._debug:
+        self._log.debug("got state: ctl=%02x dat=%02x" % (self._vpar.peek_control(), self._vpar.peek_data()))
 
   def _handle_cmd(self):
     """wait for an incoming command"""
@@ -118,12 +148,15 @@ class PBProto:
     self._log.info("got cmd: %02x" % cmd)
 
     # prepare data for packet if its a receive command
-    if cmd == self.CMD_RECV:
-      if self._recv_pkt_func is not None:
-        data = self._recv_pkt_func()
+    size = 0
+    if cmd in (self.CMD_RECV, self.CMD_RECV_BURST, self.CMD_RECV_PEEK):
+      # a peeked packet is still waiting in the buffer
+      if self._peek_size is not None:
+        size = self._peek_size
+      elif self._recv_pkt_func is not None:
+        size = self._fill_tx_buf(self._recv_pkt_func())
       else:
         self._log.warning("no recv_pkt_func set!")
-        data = ""
 
     # start timing
     ts = time.time()
@@ -131,31 +164,64 @@ class PBProto:
     # set RAK = 1
     self._set_rak(1)
     if cmd == self.CMD_SEND:
-      data = self._cmd_send(ts)
+      size = self._cmd_send(ts)
     elif cmd == self.CMD_RECV:
-      self._cmd_recv(ts, data)
+      self._peek_size = None
+      self._cmd_recv(ts, size)
+    elif cmd == self.CMD_SEND_BURST:
+      size = self._cmd_send_burst(ts)
+    elif cmd == self.CMD_RECV_BURST:
+      self._peek_size = None
+      self._cmd_recv_burst(ts, size)
+    elif cmd == self.CMD_RECV_PEEK:
+      # keep packet until the Amiga accepts or skips it
+      self._cmd_recv(ts, size, self.PEEK_SIZE)
+      self._peek_size = size
+    elif cmd == self.CMD_RECV_SKIP:
+      if self._peek_size is not None:
+        size = self._peek_size
+      self._peek_size = None
+      self._log.info("skip packet: size=%d" % size)
     else:
       self._log.error("UNKNOWN COMMAND: %02x" % cmd)
-      data = ""
 
     # --- end command
     # wait SEL == 0
     self._wait_select(0)
     # set RAK = 0
     self._set_rak(0)
+    self._vpar.flush()
 
     # end timing
     te = time.time()
     self._log.info("cmd time: delta=%.4f" % (te - ts))
 
     # process sent data
-    if cmd == self.CMD_SEND:
+    if cmd in (self.CMD_SEND, self.CMD_SEND_BURST):
       if self._send_pkt_func is not None:
-        self._send_pkt_func(data)
+        self._send_pkt_func(memoryview(self._rx_buf)[:size])
       else:
         self._log.warning("no send_pkt_func set!")
 
-    return cmd, len(data)
+    return cmd, size
+
+  def _fill_tx_buf(self, data):
+    """copy packet for the Amiga into the tx buffer and return its size"""
+    if data is None:
+      return 0
+    size = len(data)
+    # keep room for the padding byte of a burst
+    if size >= len(self._tx_buf):
+      self._tx_buf = bytearray(size + 1)
+    self._tx_buf[:size] = data
+    return size
+
+  def _get_rx_buf(self, size):
+    """return buffer for a packet sent by the Amiga"""
+    # odd sizes of a burst write a padding byte
+    if size >= len(self._rx_buf):
+      self._rx_buf = bytearray(size + 1)
+    return self._rx_buf
 
   def _cmd_send(self, ts):
     """Amiga sends a buffer"""
@@ -170,47 +236,121 @@ class PBProto:
     self._set_rak(1)
     size = hi * 256 + lo
     self._log.debug("send size: %d" % size)
-    # get data loop
+    # get data loop. odd sizes are padded to words like in the firmware
+    buf = self._get_rx_buf(size)
     toggle = False
-    data = ""
-    for i in xrange(size):
-      self._log.debug("rx #%04d/%04d" % (i, size))
-      self._wait_req(not toggle, ctx="get_data_#%d" % i, start=ts)
-      d = self._vpar.peek_data()
-      data += chr(d)
+    for i in range((size + 1) & ~1):
+      self._wait_req(not toggle, ctx="get_data_#%d", num=i, start=ts)
+      buf[i] = self._vpar.peek_data()
       self._set_rak(toggle)
       toggle = not toggle
     self._log.debug("--- incoming send ---")
-    return data
+    return size
 
-  def _cmd_recv(self, ts, data):
-    """Amiga wants to receive a buffer"""
+  def _cmd_recv(self, ts, size, max_size=None):
+    """Amiga wants to receive the tx buffer.
+       if max_size is given then only transfer this many bytes"""
     self._log.debug("+++ incoming recv +++")
-    size = len(data)
     self._log.debug("recv size: %d" % size)
-    hi = size / 256
+    hi = size // 256
     lo = size % 256
     # send size HI
     self._wait_req(1, ctx="put_size_hi", start=ts)
-    self._vpar.set_data(hi)
-    self._set_rak(0)
+    self._put_data_rak(hi, 0)
     # send size LO
     self._wait_req(0, ctx="put_size_lo", start=ts)
-    self._vpar.set_data(lo)
-    self._set_rak(1)
-    # send data
+    self._put_data_rak(lo, 1)
+    # send data. odd sizes are padded to words like in the firmware
+    if max_size is not None and max_size < size:
+      size = max_size
+    buf = self._tx_buf
+    if size & 1:
+      buf[size] = 0
     toggle = False
-    for i in xrange(size):
-      self._wait_req(not toggle, ctx="put_data_#%d" % i, start=ts)
-      self._log.debug("tx #%04d/%04d" % (i, size))
-      d = ord(data[i])
-      self._vpar.set_data(d)
-      self._set_rak(toggle)
+    for i in range((size + 1) & ~1):
+      self._wait_req(not toggle, ctx="put_data_#%d", num=i, start=ts)
+      self._put_data_rak(buf[i], toggle)
       toggle = not toggle
-    # clear buffer
-    self.recv_buf = None
     self._log.debug("--- incoming recv ---")
 
+  def _cmd_send_burst(self, ts):
+    """Amiga sends a buffer in burst mode.
+       the Amiga only syncs before and after the burst. in between it
+       writes a word per REQ toggle pair without waiting for RAK, so every
+       state update of vpar is a new byte."""
+    self._log.debug("+++ incoming send burst +++")
+    # get size HI
+    self._wait_req(1, ctx="get_size_hi", start=ts)
+    hi = self._vpar.peek_data()
+    self._set_rak(0)
+    # get size LO
+    self._wait_req(0, ctx="get_size_lo", start=ts)
+    lo = self._vpar.peek_data()
+    size = hi * 256 + lo
+    words = (size + 1) // 2
+    self._log.debug("send burst size: %d" % size)
+    # RAK = 1 starts the burst
+    self._set_rak(1)
+    buf = self._get_rx_buf(size)
+    for i in range(0, words * 2, 2):
+      # even bytes 0,2,4,...
+      self._wait_req(1, ctx="get_burst_#%d", num=i, start=ts)
+      buf[i] = self._vpar.peek_data()
+      # odd bytes 1,3,5,...
+      self._wait_req(0, ctx="get_burst_#%d", num=i + 1, start=ts)
+      buf[i + 1] = self._vpar.peek_data()
+    # burst exit sync
+    self._wait_req(1, ctx="send_burst_exit", start=ts)
+    self._set_rak(0)
+    self._wait_req(0, ctx="send_burst_final", start=ts)
+    # final ACK
+    self._set_rak(1)
+    self._log.debug("--- incoming send burst ---")
+    # padding byte of odd sizes is dropped
+    return size
+
+  def _cmd_recv_burst(self, ts, size):
+    """Amiga wants to receive the tx buffer in burst mode.
+       the Amiga toggles REQ and reads the data port right away, so each
+       byte is put on the bus before the toggle that fetches it."""
+    self._log.debug("+++ incoming recv burst +++")
+    self._log.debug("recv burst size: %d" % size)
+    hi = size // 256
+    lo = size % 256
+    # send size HI
+    self._wait_req(1, ctx="put_size_hi", start=ts)
+    self._put_data_rak(hi, 0)
+    # send size LO
+    self._wait_req(0, ctx="put_size_lo", start=ts)
+    self._put_data_rak(lo, 1)
+    # empty packet: Amiga leaves without burst
+    if size == 0:
+      return
+    # burst ready?
+    self._wait_req(1, ctx="recv_burst_ready", start=ts)
+    buf = self._tx_buf
+    total = size
+    if size & 1:
+      buf[size] = 0
+      total += 1
+    # first byte on bus, then RAK = 0 starts the burst
+    self._put_data_rak(buf[0], 0)
+    for i in range(0, total, 2):
+      # Amiga fetches even byte with REQ = 0
+      self._wait_req(0, ctx="put_burst_#%d", num=i, start=ts)
+      self._vpar.set_data(buf[i + 1])
+      # Amiga fetches odd byte with REQ = 1
+      self._wait_req(1, ctx="put_burst_#%d", num=i + 1, start=ts)
+      if i + 2 < total:
+        self._vpar.set_data(buf[i + 2])
+    # burst exit sync
+    self._wait_req(0, ctx="recv_burst_exit", start=ts)
+    self._set_rak(1)
+    self._wait_req(1, ctx="recv_burst_final", start=ts)
+    # final ACK
+    self._set_rak(0)
+    self._log.debug("--- incoming recv burst ---")
+
   def _wait_select(self, value, timeout=5, ctx="", start=0, throw=True):
     """wait for SELECT signal"""
     t = time.time()
@@ -235,16 +375,18 @@ class PBProto:
       self._vpar.poll_state(rem)
       t = time.time()
 
-    self._log.debug("wait_sel: %d (%12.6f delay)"
-                    % (value, t - begin))
+    if self._debug:
+      self._log.debug("wait_sel: %d (%12.6f delay)"
+                      % (value, t - begin))
     if not found and throw:
       delta = t - start
       raise PBProtoError("%s: no select. delta=%5.3f timeout=%d" %
                          (ctx, delta, timeout))
     return found
 
-  def _wait_req(self, expect, timeout=5, ctx="", start=0):
-    """wait for toggle on POUT signal"""
+  def _wait_req(self, expect, timeout=5, ctx="", start=0, num=None):
+    """wait for toggle on POUT signal.
+       if num is given then ctx is formatted with it on errors only"""
     #print expect
     t = time.time()
     begin = t
@@ -267,6 +409,8 @@ class PBProto:
       # check for SELECT -> arbitration loss?
       if (s & vpar.SEL_MASK) != vpar.SEL_MASK:
         delta = t - start
+        if num is not None:
+          ctx = ctx % num
         raise PBProtoError("%s: lost select in line toggle."
                            " delta=%5.3f timeout=%d"
                            % (ctx, delta, timeout))
@@ -275,10 +419,13 @@ class PBProto:
       self._vpar.poll_state(rem)
       t = time.time()
 
-    self._log.debug("wait_tog: %s (%12.6f delay)"
-                    % (expect, t - begin))
+    if self._debug:
+      self._log.debug("wait_tog: %s (%12.6f delay)"
+                      % (expect, t - begin))
     if not found:
       delta = t - start
+      if num is not None:
+        ctx = ctx % num
       raise PBProtoError("%s: missing line toggle."
                          " delta=%5.3f timeout=%d"
                          % (ctx, delta, timeout))
@@ -289,11 +436,21 @@ class PBProto:
     else:
       self._vpar.clr_control_mask(vpar.BUSY_MASK)
 
+  def _put_data_rak(self, val, rak):
+    """put a byte on the bus and set RAK.
+       only pipeline mode uses a single compound vpar command"""
+    if not self._vpar.pipeline:
+      self._vpar.set_data(val)
+      self._set_rak(rak)
+    elif rak:
+      self._vpar.set_data_control(val, set_mask=vpar.BUSY_MASK)
+    else:
+      self._vpar.set_data_control(val, clr_mask=vpar.BUSY_MASK)
+
 
 # ----- Test -----
 if __name__ == '__main__':
-  import sopty
-  import vpar
+  from . import sopty
 
   save_data = None
   count = 10
@@ -313,7 +470,7 @@ if __name__ == '__main__':
     # ping pong
     if count > 0:
       count -= 1
-      save_data = data
+      save_data = data.tobytes()
       p.request_recv()
 
   p.set_packet_handler(recv, send)
@@ -1,6 +1,7 @@
 from __future__ import print_function
 import logging
 import select
+import threading
 
 # bit masks for ctl flags
 BUSY_MASK = 1
@@ -13,13 +14,28 @@ VPAR_REPLY = 0x10
 VPAR_INIT = 0x40
 VPAR_EXIT = 0x80
 
+# command flags. a command may combine DATA with SET or CLR
+CMD_STATE = 0x00
+CMD_ACK = 0x08
+CMD_DATA = 0x10
+CMD_SET = 0x40
+CMD_CLR = 0x80
+
 class VPar:
   """implement the virtual parallel port protocol used in FS-UAE vpar patch
      to propagate the state of the parallel port of the emulated Amiga."""
 
-  def __init__(self, par_file):
+  def __init__(self, par_file, pipeline=False):
+    """in pipeline mode commands are queued and written in one go before
+       the next state is polled. replies are counted as they arrive
+       instead of waiting for each one."""
     self._log = logging.getLogger(__name__)
     self.par_file = par_file
+    self.pipeline = pipeline
+    self._cmd_buf = bytearray(2)
+    self._tx_buf = bytearray()
+    self._tx_lock = threading.Lock()
+    self.pending = 0
     self.ctl = 0
     self.dat = 0
     self.init_flag = False
@@ -97,39 +113,53 @@ class VPar:
       res += "REPLY "
     return res
 
-  def _read(self, timeout=0, what="RX"):
+  def _read(self, timeout=0, num=None):
     # poll port - if something is here read it first
     if self.can_read(timeout):
-      d = self.par_file.read(2)
-      ctl = ord(d[0])
-      dat = ord(d[1])
+      ctl, dat = bytearray(self.par_file.read(2))
       if ctl & VPAR_INIT == VPAR_INIT:
           self.init_flag = True
       if ctl & VPAR_EXIT == VPAR_EXIT:
           self.exit_flag = True
       if ctl & VPAR_REPLY == VPAR_REPLY:
+        if self.pipeline:
+          with self._tx_lock:
+            if self.pending > 0:
+              self.pending -= 1
+        else:
           self.reply_flag = True
       if ctl & VPAR_STROBE == VPAR_STROBE:
           self.strobe_flag = True
       self.ctl = ctl & 0x7
       self.dat = dat
-      self._log.debug("%s: ctl=%02x dat=%02x [%02x %02x] %s" %
-                      (what, self.ctl, self.dat, ctl, dat,
-                       self._decode_ctl(ctl)))
+      if self._log.isEnabledFor(logging.DEBUG):
+        what = "RX" if num is None else "R%d" % num
+        self._log.debug("%s: ctl=%02x dat=%02x [%02x %02x] %s" %
+                        (what, self.ctl, self.dat, ctl, dat,
+                         self._decode_ctl(ctl)))
       return True
     else:
       return False
 
-  def _write(self, data, timeout=None):
+  def _write(self, cmd, val, timeout=None):
     """return True=write+read ok, False=write or read failed"""
+    # pipeline: only queue command
+    if self.pipeline:
+      with self._tx_lock:
+        self._tx_buf.append(cmd)
+        self._tx_buf.append(val)
+      return True
     # check if we can write
     if not self.can_write(timeout):
       return False
-    self.par_file.write(data)
+    buf = self._cmd_buf
+    buf[0] = cmd
+    buf[1] = val
+    self.par_file.write(buf)
     # wait for reply from emu. skip updates
     num = 0
     while True:
-      ok = self._read(timeout, "R%d" % num)
+      ok = self._read(timeout, num)
       if not ok:
         return False
       # make sure it has reply flag set
@@ -138,43 +168,102 @@ class VPar:
       num += 1
     return True
 
+  def flush(self, timeout=None):
+    """pipeline: write all queued commands at once.
+       return True if nothing was queued or write was ok"""
+    with self._tx_lock:
+      n = len(self._tx_buf)
+      if n == 0:
+        return True
+      if not self.can_write(timeout):
+        return False
+      self.par_file.write(self._tx_buf)
+      self.pending += n // 2
+      del self._tx_buf[:]
+    return True
+
+  def sync(self, timeout=None):
+    """pipeline: flush and wait until all replies arrived.
+       state updates in between are applied in order"""
+    if not self.flush(timeout):
+      return False
+    num = 0
+    while self.pending > 0:
+      if not self._read(timeout, num):
+        return False
+      num += 1
+    return True
+
   def poll_state(self, timeout=None):
     """check if a state update is available on I/O channel
        return True if state update was available
     """
+    # the emulator can only react on commands we have sent
+    if not self.flush(timeout):
+      return False
     return self._read(timeout)
 
   def request_state(self, timeout=None):
     """request a state update from the emulator"""
     self._log.info("tx: request")
-    return self._write(chr(0)+chr(0), timeout)
+    ok = self._write(CMD_STATE, 0, timeout)
+    if ok and self.pipeline:
+      ok = self.sync(timeout)
+    return ok
 
   def trigger_ack(self):
     """trigger ACK flag of emulator's parallel port"""
-    cmd = ACK_MASK
+    cmd = CMD_ACK
     self._log.info("tx: ACK           [%02x %02x]" % (cmd, 0))
-    return self._write(chr(cmd) + chr(0))
+    ok = self._write(cmd, 0)
+    # may be called from another thread: do not wait for next poll
+    if ok and self.pipeline:
+      ok = self.flush()
+    return ok
 
   def set_control_mask(self, val, timeout=None):
     """set bits of control port"""
-    cmd = 0x40 + val
-    self._log.info("tx: SET=%02x        [%02x %02x] %s" %
-                   (val, cmd, 0, self._decode_ctl(val, True)))
-    return self._write(chr(cmd)+chr(0), timeout)
+    cmd = CMD_SET + val
+    if self._log.isEnabledFor(logging.INFO):
+      self._log.info("tx: SET=%02x        [%02x %02x] %s" %
+                     (val, cmd, 0, self._decode_ctl(val, True)))
+    return self._write(cmd, 0, timeout)
 
   def clr_control_mask(self, val, timeout=None):
     """clear bits of control port"""
-    cmd = 0x80 + val
-    self._log.info("tx: CLEAR=%02x      [%02x %02x] %s" %
-                   (val, cmd, 0, self._decode_ctl(val, True)))
-    return self._write(chr(cmd)+chr(0), timeout)
+    cmd = CMD_CLR + val
+    if self._log.isEnabledFor(logging.INFO):
+      self._log.info("tx: CLEAR=%02x      [%02x %02x] %s" %
+                     (val, cmd, 0, self._decode_ctl(val, True)))
+    return self._write(cmd, 0, timeout)
 
   def set_data(self, val, timeout=None):
     """set data port value (if configured as input)"""
-    cmd = 0x10
-    self._log.info("tx: DATA=%02x       [%02x %02x]" %
-                   (val, cmd, val))
-    return self._write(chr(cmd)+chr(val), timeout)
+    cmd = CMD_DATA
+    if self._log.isEnabledFor(logging.INFO):
+      self._log.info("tx: DATA=%02x       [%02x %02x]" %
+                     (val, cmd, val))
+    return self._write(cmd, val, timeout)
+
+  def set_data_control(self, val, set_mask=0, clr_mask=0, timeout=None):
+    """set data port value and change control bits in a single command"""
+    if set_mask and clr_mask:
+      if not self.set_data_control(val, set_mask=set_mask, timeout=timeout):
+        return False
+      return self.clr_control_mask(clr_mask, timeout)
+    if set_mask:
+      cmd = CMD_DATA + CMD_SET + set_mask
+      mask = set_mask
+    elif clr_mask:
+      cmd = CMD_DATA + CMD_CLR + clr_mask
+      mask = clr_mask
+    else:
+      return self.set_data(val, timeout)
+    if self._log.isEnabledFor(logging.INFO):
+      self._log.info("tx: DATA=%02x %s=%02x [%02x %02x] %s" %
+                     (val, "SET" if set_mask else "CLR", mask, cmd, val,
+                      self._decode_ctl(mask, True)))
+    return self._write(cmd, val, timeout)
 
   def peek_control(self):
     """get last value of control bits"""
@@ -209,7 +298,7 @@ class VPar:
 
 # ----- Test -----
 if __name__ == '__main__':
-  import sopty
+  from . import sopty
   logging.basicConfig()
   s = sopty.SoPTY('/tmp/vpar')
   v = VPar(s)
@@ -0,0 +1,6 @@
+from .port import VParPort
+from .port import ShmPort
+from .port import PortError
+from .amiga import VAmiga
+from .amiga import HWFrame
+from .traffic import TrafficMix
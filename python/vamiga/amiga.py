@@ -0,0 +1,339 @@
+from __future__ import print_function
+import time
+import struct
+import logging
+
+try:
+  range = xrange
+except NameError:
+  pass
+
+
+class HWFrame:
+  """frame buffer as used by hwpar.asm: size word followed by the data.
+     one extra byte takes the padding of odd sized transfers"""
+
+  def __init__(self, max_frame=1514):
+    self.max_frame = max_frame
+    self.buf = bytearray(max_frame + 3)
+
+  def get_size(self):
+    return struct.unpack_from(">H", self.buf, 0)[0]
+
+  def set_size(self, size):
+    struct.pack_into(">H", self.buf, 0, size)
+
+  def set_data(self, data):
+    size = len(data)
+    if size > self.max_frame:
+      raise ValueError("frame too large: %d" % size)
+    self.set_size(size)
+    self.buf[2:2 + size] = data
+
+  def get_data(self):
+    """return a view of the frame data. only valid until next transfer"""
+    return memoryview(self.buf)[2:2 + self.get_size()]
+
+  def get_type(self):
+    return struct.unpack_from(">H", self.buf, 14)[0]
+
+
+class VAmiga:
+  """a virtual Amiga that runs the low level routines of the plipbox
+     driver (hwpar.asm) on a port of vamiga.port.
+
+     all hw*() calls follow the handshake of the assembler version step
+     by step and return True if the transfer was ok. the timeout covers
+     the whole call like the timer request of hw.c.
+
+     FLG edges of the plipbox are seen whenever the port is polled and
+     handled like _interrupt: the first edge sets recv_pending and
+     signals the server, more edges are dropped until a recv, peek or
+     skip clears the flag again.
+  """
+
+  # commands
+  CMD_SEND = 0x11
+  CMD_RECV = 0x22
+  CMD_SEND_BURST = 0x33
+  CMD_RECV_BURST = 0x44
+  CMD_RECV_PEEK = 0x55
+  CMD_RECV_SKIP = 0x66
+
+  PEEK_SIZE = 14
+
+  def __init__(self, port, timeout=1.0, max_frame=1514):
+    self._log = logging.getLogger(__name__)
+    self._port = port
+    self.timeout = timeout
+    self.max_frame = max_frame
+    self._deadline = 0
+    self._flg = 0
+    # HWB_RECV_PENDING and the signal of the server task
+    self.recv_pending = False
+    self.signal = False
+    # counters
+    self.num_irq = 0
+    self.num_irq_skipped = 0
+
+  def open(self):
+    self._port.open()
+    self._flg = self._port.get_flg()
+
+  def close(self):
+    self._port.close()
+
+  # ----- interrupt -----
+
+  def _interrupt(self):
+    """FLG interrupt server"""
+    if self.recv_pending:
+      self.num_irq_skipped += 1
+      return
+    self.recv_pending = True
+    self.signal = True
+    self.num_irq += 1
+
+  def _check_flg(self):
+    flg = self._port.get_flg()
+    while self._flg != flg:
+      self._flg = (self._flg + 1) & 0xffffffff
+      self._interrupt()
+
+  def poll(self, timeout=0):
+    """process port updates and FLG edges"""
+    self._port.poll(timeout)
+    self._check_flg()
+
+  def wait_signal(self, timeout):
+    """wait for the signal of the interrupt and clear it.
+       return False on timeout"""
+    end = time.time() + timeout
+    while True:
+      self._check_flg()
+      if self.signal:
+        self.signal = False
+        return True
+      rem = end - time.time()
+      if rem <= 0:
+        return False
+      self._port.poll(rem)
+
+  def _reset_signal(self):
+    self.signal = False
+    self.recv_pending = False
+
+  # ----- helpers -----
+
+  def _start(self):
+    self._deadline = time.time() + self.timeout
+
+  def _wait_rak(self, val):
+    port = self._port
+    while port.get_rak() != val:
+      rem = self._deadline - time.time()
+      if rem <= 0:
+        if self._log.isEnabledFor(logging.DEBUG):
+          self._log.debug("timeout waiting for RAK=%d" % val)
+        return False
+      port.poll(rem)
+      self._check_flg()
+    return True
+
+  def _begin_cmd(self, cmd):
+    """wait RAK=0, put command on bus and raise SEL"""
+    if not self._wait_rak(0):
+      return False
+    port = self._port
+    port.set_output(True)
+    port.set_data(cmd)
+    port.set_sel(1)
+    return True
+
+  def _read_size(self, frame):
+    """read size word after the command was confirmed.
+       return size or None on error"""
+    port = self._port
+    buf = frame.buf
+    if not self._wait_rak(1):
+      return None
+    port.set_output(False)
+    port.set_req(1)
+    if not self._wait_rak(0):
+      return None
+    buf[0] = port.get_data()
+    port.set_req(0)
+    if not self._wait_rak(1):
+      return None
+    buf[1] = port.get_data()
+    port.set_req(1)
+    return frame.get_size()
+
+  def _read_words(self, frame, size):
+    """read size bytes (rounded up to words) with full handshake"""
+    port = self._port
+    buf = frame.buf
+    p = 2
+    for i in range((size + 1) >> 1):
+      if not self._wait_rak(0):
+        return False
+      buf[p] = port.get_data()
+      port.set_req(0)
+      if not self._wait_rak(1):
+        return False
+      buf[p + 1] = port.get_data()
+      port.set_req(1)
+      p += 2
+    return True
+
+  # ----- transfers -----
+
+  def hwsend(self, frame):
+    """send frame with a handshake for each byte"""
+    self._start()
+    port = self._port
+    rc = False
+    if self._begin_cmd(self.CMD_SEND):
+      buf = frame.buf
+      # words of data plus the size word
+      words = ((frame.get_size() + 1) >> 1) + 1
+      p = 0
+      for i in range(words):
+        if not self._wait_rak(1):
+          break
+        port.set_data(buf[p])
+        port.set_req(1)
+        if not self._wait_rak(0):
+          break
+        port.set_data(buf[p + 1])
+        port.set_req(0)
+        p += 2
+      else:
+        rc = self._wait_rak(1)
+    port.set_output(False)
+    port.set_sel(0)
+    return rc
+
+  def hwrecv(self, frame):
+    """receive frame with a handshake for each byte"""
+    self._start()
+    port = self._port
+    rc = False
+    if self._begin_cmd(self.CMD_RECV):
+      size = self._read_size(frame)
+      if size == 0:
+        rc = True
+      elif size is not None and size <= self.max_frame:
+        rc = self._read_words(frame, size)
+    self._reset_signal()
+    port.set_req(0)
+    port.set_sel(0)
+    return rc
+
+  def hwburstsend(self, frame):
+    """send frame in burst mode: only the size is handshaked"""
+    self._start()
+    port = self._port
+    rc = False
+    buf = frame.buf
+    size = frame.get_size()
+    if self._begin_cmd(self.CMD_SEND_BURST):
+      ok = self._wait_rak(1)
+      if ok:
+        port.set_data(buf[0])
+        port.set_req(1)
+        ok = self._wait_rak(0)
+      if ok:
+        port.set_data(buf[1])
+        port.set_req(0)
+        ok = self._wait_rak(1)
+      if ok:
+        # burst loop: no waits (irqs are disabled on the Amiga)
+        for p in range(2, ((size + 1) & ~1) + 2, 2):
+          port.set_data(buf[p])
+          port.set_req(1)
+          port.set_data(buf[p + 1])
+          port.set_req(0)
+        port.set_req(1)
+        ok = self._wait_rak(0)
+      if ok:
+        port.set_req(0)
+        rc = self._wait_rak(1)
+    port.set_output(False)
+    port.set_sel(0)
+    return rc
+
+  def hwburstrecv(self, frame):
+    """receive frame in burst mode: only the size is handshaked.
+
+       the Amiga toggles REQ and reads the bus right away, before the
+       plipbox reacts with the next byte. python is too slow for this
+       window, so each byte is read just before its REQ toggle. the bus
+       already holds the same value then.
+    """
+    self._start()
+    port = self._port
+    rc = False
+    if self._begin_cmd(self.CMD_RECV_BURST):
+      size = self._read_size(frame)
+      if size == 0:
+        rc = True
+      elif size is not None and size <= self.max_frame:
+        rc = self._burst_read(frame, size)
+    self._reset_signal()
+    port.set_req(0)
+    port.set_sel(0)
+    return rc
+
+  def _burst_read(self, frame, size):
+    port = self._port
+    buf = frame.buf
+    # sync before burst
+    if not self._wait_rak(0):
+      return False
+    port.burst_begin()
+    deadline = self._deadline
+    num = (size + 1) & ~1
+    for i in range(0, num, 2):
+      if not port.burst_sync(i, deadline):
+        return False
+      buf[i + 2] = port.get_data()
+      port.set_req(0)
+      if not port.burst_sync(i + 1, deadline):
+        return False
+      buf[i + 3] = port.get_data()
+      port.set_req(1)
+    port.set_req(0)
+    # sync after burst
+    if not self._wait_rak(1):
+      return False
+    port.set_req(1)
+    return self._wait_rak(0)
+
+  def hwpeek(self, frame):
+    """receive size and only the ethernet header of the next frame"""
+    self._start()
+    port = self._port
+    rc = False
+    if self._begin_cmd(self.CMD_RECV_PEEK):
+      size = self._read_size(frame)
+      if size == 0:
+        rc = True
+      elif size is not None and size <= self.max_frame:
+        rc = self._read_words(frame, min(size, self.PEEK_SIZE))
+    self._reset_signal()
+    port.set_req(0)
+    port.set_sel(0)
+    return rc
+
+  def hwskip(self):
+    """drop the frame announced by hwpeek()"""
+    self._start()
+    port = self._port
+    rc = False
+    if self._begin_cmd(self.CMD_RECV_SKIP):
+      rc = self._wait_rak(1)
+    port.set_output(False)
+    self._reset_signal()
+    port.set_sel(0)
+    return rc
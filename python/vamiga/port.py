@@ -0,0 +1,282 @@
+from __future__ import print_function
+import os
+import mmap
+import time
+import errno
+import select
+import struct
+import logging
+
+from pbuae import vpar
+
+
+class PortError(Exception):
+  """errors raised while opening a port"""
+  pass
+
+
+class VParPort:
+  """the Amiga end of a vpar link, i.e. the part FS-UAE plays.
+
+     the Amiga drives data, POUT (REQ) and SEL and every change is sent
+     as a state message. commands of the plipbox emulator update BUSY
+     (RAK) and the data input, an ACK command is a FLG edge. each command
+     is answered with a state message that has the REPLY flag set.
+
+     give a PTY (e.g. /tmp/vpar of the emulator or /tmp/hpar of
+     vpar_socat) or a pair of named pipes with out_path.
+  """
+
+  def __init__(self, path, out_path=None):
+    self._log = logging.getLogger(__name__)
+    self.path = path
+    self.out_path = out_path
+    self._in_fd = None
+    self._out_fd = None
+    self._rx = bytearray()
+    self._tx = bytearray()
+    # lines
+    self.busy = 0
+    self.pout = 0
+    self.sel = 0
+    self.data_out = 0
+    self.data_in = 0
+    self.output = False
+    # counters
+    self.flg = 0
+    self.data_cmds = 0
+    self._data_mark = 0
+
+  def open(self):
+    try:
+      if self.out_path is None:
+        fd = os.open(self.path, os.O_RDWR | os.O_NOCTTY)
+        self._in_fd = fd
+        self._out_fd = fd
+      else:
+        # O_RDWR does not block on a fifo without a peer
+        self._in_fd = os.open(self.path, os.O_RDWR)
+        self._out_fd = os.open(self.out_path, os.O_RDWR)
+    except OSError as e:
+      self.close()
+      raise PortError("can't open vpar port '%s': %s" % (self.path, e))
+    # FS-UAE announces itself with the INIT flag
+    self._send_state(vpar.VPAR_INIT)
+
+  def close(self):
+    if self._out_fd is not None:
+      try:
+        self._send_state(vpar.VPAR_EXIT)
+      except OSError:
+        pass
+      if self._out_fd != self._in_fd:
+        os.close(self._out_fd)
+      self._out_fd = None
+    if self._in_fd is not None:
+      os.close(self._in_fd)
+      self._in_fd = None
+
+  def get_fd(self):
+    return self._in_fd
+
+  def _state(self, flags=0):
+    ctl = self.busy | (self.pout << 1) | (self.sel << 2) | flags
+    dat = self.data_out if self.output else self.data_in
+    return ctl, dat
+
+  def _send_state(self, flags=0):
+    ctl, dat = self._state(flags)
+    self._tx.append(ctl)
+    self._tx.append(dat)
+    self._flush()
+
+  def _flush(self):
+    while len(self._tx) > 0:
+      n = os.write(self._out_fd, self._tx)
+      del self._tx[:n]
+
+  def poll(self, timeout=0):
+    """process all pending commands of the emulator.
+       return number of commands handled"""
+    fd = self._in_fd
+    ready = select.select([fd], [], [], timeout)[0]
+    if len(ready) == 0:
+      return 0
+    try:
+      data = os.read(fd, 4096)
+    except OSError as e:
+      if e.errno == errno.EAGAIN:
+        return 0
+      raise
+    rx = self._rx
+    rx += data
+    n = len(rx) & ~1
+    for i in range(0, n, 2):
+      cmd = rx[i]
+      if cmd & vpar.CMD_ACK:
+        self.flg += 1
+      if cmd & vpar.CMD_DATA:
+        self.data_in = rx[i + 1]
+        self.data_cmds += 1
+      mask = cmd & 7
+      if cmd & vpar.CMD_SET:
+        self._set_mask(mask, 1)
+      elif cmd & vpar.CMD_CLR:
+        self._set_mask(mask, 0)
+      # answers of all commands are written in one go
+      ctl, dat = self._state(vpar.VPAR_REPLY)
+      self._tx.append(ctl)
+      self._tx.append(dat)
+    del rx[:n]
+    self._flush()
+    if self._log.isEnabledFor(logging.DEBUG):
+      self._log.debug("poll: %d cmds: busy=%d data_in=%02x flg=%d" %
+                      (n // 2, self.busy, self.data_in, self.flg))
+    return n // 2
+
+  def _set_mask(self, mask, val):
+    if mask & vpar.BUSY_MASK:
+      self.busy = val
+    if mask & vpar.POUT_MASK:
+      self.pout = val
+    if mask & vpar.SEL_MASK:
+      self.sel = val
+
+  # ----- Amiga side -----
+
+  def get_rak(self):
+    return self.busy
+
+  def get_flg(self):
+    return self.flg
+
+  def set_output(self, on):
+    self.output = on
+
+  def set_data(self, val):
+    self.data_out = val
+    if self.output:
+      # a write to the CIA port pulses /STROBE
+      self._send_state(vpar.VPAR_STROBE)
+
+  def get_data(self):
+    return self.data_in
+
+  def set_req(self, val):
+    if self.pout != val:
+      self.pout = val
+      self._send_state()
+
+  def set_sel(self, val):
+    if self.sel != val:
+      self.sel = val
+      self._send_state()
+
+  def burst_begin(self):
+    """start counting data commands of a burst"""
+    self._data_mark = self.data_cmds
+
+  def burst_sync(self, num, deadline):
+    """wait until the emulator put byte num of the burst on the bus.
+       the first byte came with the RAK change that started the burst"""
+    while self.data_cmds - self._data_mark < num:
+      rem = deadline - time.time()
+      if rem <= 0:
+        return False
+      self.poll(rem)
+    return True
+
+
+class ShmPort:
+  """the Amiga end of the simulated parallel port of the host firmware.
+     see avr/src/host/par_sim.h for the layout. each line uses bit 0 of
+     its byte and the FLG edges are counted by the firmware.
+
+     the burst loops of the firmware do not handshake each byte. they
+     only keep up if the firmware has a CPU of its own.
+  """
+
+  OFF_DATA_IN = 0
+  OFF_STROBE = 1
+  OFF_SELECT = 2
+  OFF_POUT = 3
+  OFF_DATA_OUT = 4
+  OFF_DATA_DDR = 5
+  OFF_BUSY = 6
+  OFF_ACK = 7
+  OFF_ACK_PULSES = 8
+  SIZE = 12
+
+  def __init__(self, name='/plipbox_par'):
+    self.name = name
+    self._map = None
+    self.output = False
+
+  def open(self):
+    path = os.path.join('/dev/shm', self.name.lstrip('/'))
+    try:
+      fd = os.open(path, os.O_RDWR)
+    except OSError as e:
+      raise PortError("can't open '%s' (firmware running?): %s" % (path, e))
+    try:
+      self._map = mmap.mmap(fd, self.SIZE, mmap.MAP_SHARED,
+                            mmap.PROT_READ | mmap.PROT_WRITE)
+    finally:
+      os.close(fd)
+    # idle lines: /STROBE is high, SEL and POUT are low
+    self._put(self.OFF_STROBE, 1)
+    self._put(self.OFF_SELECT, 0)
+    self._put(self.OFF_POUT, 0)
+
+  def close(self):
+    if self._map is not None:
+      self._put(self.OFF_SELECT, 0)
+      self._put(self.OFF_POUT, 0)
+      self._map.close()
+      self._map = None
+
+  def get_fd(self):
+    return None
+
+  def _get(self, off):
+    return struct.unpack_from("B", self._map, off)[0]
+
+  def _put(self, off, val):
+    struct.pack_into("B", self._map, off, val)
+
+  def poll(self, timeout=0):
+    """the lines are polled directly. only give up the CPU"""
+    if timeout:
+      time.sleep(0)
+    return 0
+
+  # ----- Amiga side -----
+
+  def get_rak(self):
+    return self._get(self.OFF_BUSY) & 1
+
+  def get_flg(self):
+    return struct.unpack_from("I", self._map, self.OFF_ACK_PULSES)[0]
+
+  def set_output(self, on):
+    self.output = on
+
+  def set_data(self, val):
+    self._put(self.OFF_DATA_IN, val)
+
+  def get_data(self):
+    return self._get(self.OFF_DATA_OUT)
+
+  def set_req(self, val):
+    self._put(self.OFF_POUT, val)
+
+  def set_sel(self, val):
+    self._put(self.OFF_SELECT, val)
+
+  def burst_begin(self):
+    pass
+
+  def burst_sync(self, num, deadline):
+    """the firmware puts the next byte on the bus right after the last
+       REQ toggle. there is nothing to wait for"""
+    return True
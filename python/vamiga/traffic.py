@@ -0,0 +1,123 @@
+from __future__ import print_function
+import random
+import struct
+
+# magic frame types understood by the plipbox
+MAGIC_ONLINE = 0xffff
+MAGIC_OFFLINE = 0xfffe
+MAGIC_LOOPBACK = 0xfffd
+MAGIC_MCAST = 0xfffc
+
+# local experimental ethertype of generated frames
+TEST_TYPE = 0x88b5
+
+BCAST_MAC = b"\xff" * 6
+HDR_SIZE = 14
+# header, sequence number and pattern start
+MIN_SIZE = HDR_SIZE + 5
+
+# simple IMIX as frame sizes and weights
+IMIX = ((64, 7), (594, 4), (1514, 1))
+
+
+def parse_mac(mac):
+  """parse 'xx:xx:xx:xx:xx:xx' into raw bytes"""
+  return bytes(bytearray(int(x, 16) for x in mac.split(':')))
+
+
+def magic_frame(magic, src_mac, size=HDR_SIZE):
+  """build a magic frame sent to the plipbox itself"""
+  buf = bytearray(size)
+  buf[0:6] = BCAST_MAC
+  buf[6:12] = src_mac
+  struct.pack_into(">H", buf, 12, magic)
+  return buf
+
+
+class TrafficMix:
+  """generate test frames for a weighted mix of operations.
+
+     ops is a dict of op name to weight, e.g. {'send': 3, 'burst': 1}.
+     sizes is '<n>', '<min>-<max>' or 'imix'. each frame carries a
+     sequence number and a pattern derived from it so a receiver can
+     check the payload.
+  """
+
+  def __init__(self, ops, sizes, src_mac, dst_mac=BCAST_MAC, seed=None):
+    self._rnd = random.Random(seed)
+    self.src_mac = src_mac
+    self.dst_mac = dst_mac
+    self._ops = self._cumulate(ops.items())
+    self._sizes = self._parse_sizes(sizes)
+    self.seq = 0
+
+  def _cumulate(self, items):
+    res = []
+    total = 0
+    for key, weight in items:
+      if weight > 0:
+        total += weight
+        res.append((total, key))
+    if total == 0:
+      raise ValueError("empty mix")
+    return res
+
+  def _pick(self, table):
+    val = self._rnd.uniform(0, table[-1][0])
+    for total, key in table:
+      if val < total:
+        return key
+    return table[-1][1]
+
+  def _parse_sizes(self, sizes):
+    if sizes == 'imix':
+      return ('table', self._cumulate(IMIX))
+    if '-' in sizes:
+      lo, hi = (int(x) for x in sizes.split('-'))
+    else:
+      lo = hi = int(sizes)
+    if lo < MIN_SIZE or hi < lo:
+      raise ValueError("invalid sizes: %s" % sizes)
+    return ('range', (lo, hi))
+
+  def next_size(self):
+    kind, val = self._sizes
+    if kind == 'table':
+      return self._pick(val)
+    return self._rnd.randint(*val)
+
+  def next_op(self):
+    return self._pick(self._ops)
+
+  def make_frame(self, size):
+    buf = bytearray(size)
+    buf[0:6] = self.dst_mac
+    buf[6:12] = self.src_mac
+    seq = self.seq
+    self.seq = (seq + 1) & 0xffffffff
+    struct.pack_into(">HI", buf, 12, TEST_TYPE, seq)
+    buf[HDR_SIZE + 4:] = _pattern(seq, HDR_SIZE + 4, size)
+    return buf
+
+
+def _pattern(seq, start, end):
+  return bytearray((seq + i) & 0xff for i in range(start, end))
+
+
+def check_frame(data):
+  """classify a received frame: 'test', 'bad', 'magic' or 'other'"""
+  size = len(data)
+  if size < HDR_SIZE:
+    return 'bad'
+  eth_type = struct.unpack_from(">H", data, 12)[0]
+  if eth_type >= MAGIC_MCAST:
+    return 'magic'
+  if eth_type != TEST_TYPE:
+    return 'other'
+  if size < MIN_SIZE:
+    return 'bad'
+  seq = struct.unpack_from(">I", data, HDR_SIZE)[0]
+  start = HDR_SIZE + 4
+  if bytearray(data[start:]) != _pattern(seq, start, size):
+    return 'bad'
+  return 'test'